@@ -0,0 +1,439 @@
+#include "corpus_loader.h"
+#include <algorithm>
+#include <charconv>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+void SkipSpaces(std::string_view& text) {
+    const auto pos = text.find_first_not_of(" \t\r");
+    text.remove_prefix(pos == text.npos ? text.size() : pos);
+}
+
+void Expect(std::string_view& text, char c) {
+    if (text.empty() || text[0] != c) {
+        throw std::invalid_argument(std::string{ "expected '" } + c + "'");
+    }
+    text.remove_prefix(1);
+}
+
+// Пропускает запятую-разделитель и пробелы за ней; возвращает false, если запятой нет
+bool SkipComma(std::string_view& text) {
+    if (text.empty() || text[0] != ',') {
+        return false;
+    }
+    text.remove_prefix(1);
+    SkipSpaces(text);
+    return true;
+}
+
+int ReadInt(std::string_view& text) {
+    int value = 0;
+    const auto [ptr, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{}) {
+        throw std::invalid_argument("expected integer");
+    }
+    text.remove_prefix(ptr - text.data());
+    return value;
+}
+
+DocumentStatus ParseStatus(std::string_view status) {
+    if (status == "ACTUAL") {
+        return DocumentStatus::ACTUAL;
+    }
+    if (status == "IRRELEVANT") {
+        return DocumentStatus::IRRELEVANT;
+    }
+    if (status == "BANNED") {
+        return DocumentStatus::BANNED;
+    }
+    if (status == "REMOVED") {
+        return DocumentStatus::REMOVED;
+    }
+    throw std::invalid_argument("unknown status \"" + std::string{ status } + "\"");
+}
+
+void AppendUtf8(std::string& out, uint32_t code_point) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    }
+    else if (code_point < 0x800) {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if (code_point < 0x10000) {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+uint32_t ReadHex4(std::string_view& text) {
+    uint32_t value = 0;
+    if (text.size() < 4) {
+        throw std::invalid_argument("bad \\u escape");
+    }
+    const auto [ptr, error] = std::from_chars(text.data(), text.data() + 4, value, 16);
+    if (error != std::errc{} || ptr != text.data() + 4) {
+        throw std::invalid_argument("bad \\u escape");
+    }
+    text.remove_prefix(4);
+    return value;
+}
+
+// Строка без escape-последовательностей возвращается как view на файл,
+// иначе раскодируется в decoded_texts
+std::string_view ReadJsonString(std::string_view& text, std::list<std::string>& decoded_texts) {
+    Expect(text, '"');
+    const auto end = text.find_first_of("\"\\");
+    if (end == text.npos) {
+        throw std::invalid_argument("unterminated string");
+    }
+    if (text[end] == '"') {
+        const std::string_view result = text.substr(0, end);
+        text.remove_prefix(end + 1);
+        return result;
+    }
+
+    std::string& decoded = decoded_texts.emplace_back(text.substr(0, end));
+    text.remove_prefix(end);
+    while (!text.empty() && text[0] != '"') {
+        if (text[0] != '\\') {
+            decoded += text[0];
+            text.remove_prefix(1);
+            continue;
+        }
+        if (text.size() < 2) {
+            throw std::invalid_argument("unterminated string");
+        }
+        const char escape = text[1];
+        text.remove_prefix(2);
+        switch (escape) {
+        case '"': decoded += '"'; break;
+        case '\\': decoded += '\\'; break;
+        case '/': decoded += '/'; break;
+        case 'b': decoded += '\b'; break;
+        case 'f': decoded += '\f'; break;
+        case 'n': decoded += '\n'; break;
+        case 'r': decoded += '\r'; break;
+        case 't': decoded += '\t'; break;
+        case 'u': {
+            uint32_t code_point = ReadHex4(text);
+            if (code_point >= 0xDC00 && code_point < 0xE000) {
+                throw std::invalid_argument("unpaired surrogate in \\u escape");
+            }
+            // символ вне BMP записывается парой суррогатов
+            if (code_point >= 0xD800 && code_point < 0xDC00) {
+                if (text.substr(0, 2) != "\\u") {
+                    throw std::invalid_argument("unpaired surrogate in \\u escape");
+                }
+                text.remove_prefix(2);
+                const uint32_t low_surrogate = ReadHex4(text);
+                if (low_surrogate < 0xDC00 || low_surrogate >= 0xE000) {
+                    throw std::invalid_argument("unpaired surrogate in \\u escape");
+                }
+                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+            }
+            AppendUtf8(decoded, code_point);
+            break;
+        }
+        default:
+            throw std::invalid_argument(std::string{ "bad escape \\" } + escape);
+        }
+    }
+    Expect(text, '"');
+    return decoded;
+}
+
+void SkipJsonValue(std::string_view& text) {
+    int depth = 0;
+    while (!text.empty()) {
+        const char c = text[0];
+        if (c == '"') {
+            text.remove_prefix(1);
+            while (!text.empty() && text[0] != '"') {
+                text.remove_prefix(text[0] == '\\' && text.size() > 1 ? 2 : 1);
+            }
+            Expect(text, '"');
+            if (depth == 0) {
+                return;
+            }
+            continue;
+        }
+        if (c == '[' || c == '{') {
+            ++depth;
+        }
+        else if (c == ']' || c == '}') {
+            if (depth == 0) {
+                return;
+            }
+            --depth;
+        }
+        else if (c == ',' && depth == 0) {
+            return;
+        }
+        text.remove_prefix(1);
+        if (depth == 0 && (c == ']' || c == '}')) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+Corpus::Corpus(const std::string& path, CorpusFormat format)
+    : format_(format)
+{
+#ifdef _WIN32
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Cannot open corpus file \"" + path + "\".");
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open corpus file \"" + path + "\".");
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat corpus file \"" + path + "\".");
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ > 0) {
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Cannot map corpus file \"" + path + "\".");
+        }
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapping);
+    }
+    close(fd);
+#endif
+}
+
+Corpus::~Corpus() {
+#ifndef _WIN32
+    if (size_ > 0) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+int Corpus::LoadInto(SearchServer& search_server) {
+    const size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+    const size_t chunk_count = std::max<size_t>(1, std::min(thread_count, size_ / MIN_CHUNK_SIZE));
+
+    std::vector<std::future<ParsedChunk>> parsed_chunks;
+    for (std::string_view chunk : SplitIntoChunks(chunk_count)) {
+        parsed_chunks.push_back(std::async(std::launch::async,
+            [this, chunk] {
+                return ParseChunk(chunk);
+            }));
+    }
+
+    std::vector<ParsedChunk> chunks;
+    for (auto& parsed_chunk : parsed_chunks) {
+        chunks.push_back(parsed_chunk.get());
+    }
+    // Все проверки, из-за которых AddDocument может бросить исключение, делаются до первого добавления,
+    // поэтому при ошибке сервер остаётся нетронутым
+    ValidateIds(search_server, chunks);
+
+    int document_count = 0;
+    std::vector<int> ratings;
+    for (ParsedChunk& chunk : chunks) {
+        decoded_texts_.splice(decoded_texts_.end(), chunk.decoded_texts);
+        for (const ParsedDocument& document : chunk.documents) {
+            ratings.assign(chunk.ratings.begin() + document.ratings_begin, chunk.ratings.begin() + document.ratings_end);
+            search_server.AddDocument(document.id, document.text, document.status, ratings);
+            ++document_count;
+        }
+    }
+    return document_count;
+}
+
+void Corpus::ValidateIds(SearchServer& search_server, const std::vector<ParsedChunk>& chunks) const {
+    std::vector<const ParsedDocument*> documents;
+    for (const ParsedChunk& chunk : chunks) {
+        for (const ParsedDocument& document : chunk.documents) {
+            documents.push_back(&document);
+        }
+    }
+    std::stable_sort(documents.begin(), documents.end(),
+        [](const ParsedDocument* lhs, const ParsedDocument* rhs) {
+            return lhs->id < rhs->id;
+        });
+
+    auto it_server = search_server.begin();
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const ParsedDocument& document = *documents[i];
+        if (i > 0 && documents[i - 1]->id == document.id) {
+            ThrowParseError(document.line, "duplicate id " + std::to_string(document.id));
+        }
+        while (it_server != search_server.end() && *it_server < document.id) {
+            ++it_server;
+        }
+        if (it_server != search_server.end() && *it_server == document.id) {
+            ThrowParseError(document.line, "id " + std::to_string(document.id) + " is already in the server");
+        }
+    }
+}
+
+std::vector<std::string_view> Corpus::SplitIntoChunks(size_t chunk_count) const {
+    const std::string_view data(data_, size_);
+    std::vector<std::string_view> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; i <= chunk_count && begin < size_; ++i) {
+        size_t end = data.find('\n', std::max(begin, size_ * i / chunk_count));
+        end = end == data.npos ? size_ : end + 1;
+        chunks.push_back(data.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+Corpus::ParsedChunk Corpus::ParseChunk(std::string_view chunk) const {
+    ParsedChunk parsed_chunk;
+    while (!chunk.empty()) {
+        const auto end = chunk.find('\n');
+        std::string_view line = chunk.substr(0, end);
+        chunk.remove_prefix(end == chunk.npos ? chunk.size() : end + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.find_first_not_of(" \t") == line.npos) {
+            continue;
+        }
+        try {
+            if (format_ == CorpusFormat::TSV) {
+                ParseTsvLine(line, parsed_chunk);
+            }
+            else {
+                ParseJsonLine(line, parsed_chunk);
+            }
+        }
+        catch (const std::invalid_argument& e) {
+            ThrowParseError(line, e.what());
+        }
+    }
+    return parsed_chunk;
+}
+
+void Corpus::ParseTsvLine(std::string_view line, ParsedChunk& chunk) const {
+    const std::string_view full_line = line;
+    std::string_view fields[3];
+    for (std::string_view& field : fields) {
+        const auto tab = line.find('\t');
+        if (tab == line.npos) {
+            throw std::invalid_argument("expected 4 tab-separated fields");
+        }
+        field = line.substr(0, tab);
+        line.remove_prefix(tab + 1);
+    }
+
+    ParsedDocument document{ 0, DocumentStatus::ACTUAL, chunk.ratings.size(), 0, line, full_line };
+    std::string_view id = fields[0];
+    document.id = ReadInt(id);
+    if (!id.empty()) {
+        throw std::invalid_argument("expected integer id");
+    }
+    ValidateDocument(document);
+    document.status = ParseStatus(fields[1]);
+    std::string_view ratings = fields[2];
+    for (SkipSpaces(ratings); !ratings.empty(); SkipSpaces(ratings)) {
+        chunk.ratings.push_back(ReadInt(ratings));
+    }
+    document.ratings_end = chunk.ratings.size();
+    chunk.documents.push_back(document);
+}
+
+void Corpus::ValidateDocument(const ParsedDocument& document) {
+    if (document.id < 0) {
+        throw std::invalid_argument("negative id");
+    }
+    if (std::any_of(document.text.begin(), document.text.end(), [](char c) { return c >= '\0' && c < ' '; })) {
+        throw std::invalid_argument("control characters in text");
+    }
+}
+
+void Corpus::ParseJsonLine(std::string_view line, ParsedChunk& chunk) const {
+    ParsedDocument document{ 0, DocumentStatus::ACTUAL, chunk.ratings.size(), chunk.ratings.size(), {}, line };
+    bool has_id = false;
+    bool has_text = false;
+
+    SkipSpaces(line);
+    Expect(line, '{');
+    SkipSpaces(line);
+    for (bool has_next_member = line.empty() || line[0] != '}'; has_next_member; ) {
+        const std::string_view key = ReadJsonString(line, chunk.decoded_texts);
+        SkipSpaces(line);
+        Expect(line, ':');
+        SkipSpaces(line);
+        if (key == "id") {
+            document.id = ReadInt(line);
+            has_id = true;
+        }
+        else if (key == "status") {
+            document.status = ParseStatus(ReadJsonString(line, chunk.decoded_texts));
+        }
+        else if (key == "ratings") {
+            Expect(line, '[');
+            SkipSpaces(line);
+            for (bool has_next_rating = line.empty() || line[0] != ']'; has_next_rating; ) {
+                chunk.ratings.push_back(ReadInt(line));
+                SkipSpaces(line);
+                has_next_rating = SkipComma(line);
+            }
+            Expect(line, ']');
+            document.ratings_end = chunk.ratings.size();
+        }
+        else if (key == "text") {
+            document.text = ReadJsonString(line, chunk.decoded_texts);
+            has_text = true;
+        }
+        else {
+            SkipJsonValue(line);
+        }
+        SkipSpaces(line);
+        has_next_member = SkipComma(line);
+    }
+    Expect(line, '}');
+    SkipSpaces(line);
+    if (!line.empty()) {
+        throw std::invalid_argument("unexpected characters after object");
+    }
+    if (!has_id || !has_text) {
+        throw std::invalid_argument("expected \"id\" and \"text\" fields");
+    }
+    ValidateDocument(document);
+    chunk.documents.push_back(document);
+}
+
+void Corpus::ThrowParseError(std::string_view line, const std::string& message) const {
+    const auto line_number = std::count(data_, line.data(), '\n') + 1;
+    throw std::invalid_argument("Corpus parse error at line " + std::to_string(line_number) + ": " + message + ".");
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <list>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "document.h"
+#include "search_server.h"
+
+// TSV:   id<TAB>status<TAB>ratings через пробел<TAB>text
+// JSONL: {"id": 1, "status": "ACTUAL", "ratings": [1, 2], "text": "..."}
+enum class CorpusFormat { TSV, JSONL, };
+
+// Корпус документов, отображённый в память. SearchServer хранит string_view на тексты документов,
+// поэтому объект Corpus должен жить дольше сервера, в который он загружен.
+class Corpus {
+public:
+    Corpus(const std::string& path, CorpusFormat format);
+    ~Corpus();
+
+    Corpus(const Corpus&) = delete;
+    Corpus& operator=(const Corpus&) = delete;
+
+    // Разбирает файл параллельно кусками по границам строк и добавляет документы в сервер.
+    // Ошибки разбора, отрицательные и повторяющиеся id, а также id, уже занятые в сервере,
+    // обнаруживаются до добавления первого документа: в этом случае сервер не меняется.
+    // Возвращает число добавленных документов.
+    int LoadInto(SearchServer& search_server);
+
+private:
+    struct ParsedDocument {
+        int id;
+        DocumentStatus status;
+        size_t ratings_begin;
+        size_t ratings_end;
+        std::string_view text;
+        std::string_view line;
+    };
+
+    // Рейтинги всех документов куска лежат в одном векторе, чтобы не выделять память на каждую строку.
+    // Тексты JSON с escape-последовательностями раскодируются в decoded_texts.
+    struct ParsedChunk {
+        std::vector<ParsedDocument> documents;
+        std::vector<int> ratings;
+        std::list<std::string> decoded_texts;
+    };
+
+    const CorpusFormat format_;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::string buffer_;
+    std::list<std::string> decoded_texts_;
+
+    std::vector<std::string_view> SplitIntoChunks(size_t chunk_count) const;
+
+    ParsedChunk ParseChunk(std::string_view chunk) const;
+
+    void ValidateIds(SearchServer& search_server, const std::vector<ParsedChunk>& chunks) const;
+
+    // Проверки, которые иначе бросили бы исключение из AddDocument
+    static void ValidateDocument(const ParsedDocument& document);
+
+    void ParseTsvLine(std::string_view line, ParsedChunk& chunk) const;
+
+    void ParseJsonLine(std::string_view line, ParsedChunk& chunk) const;
+
+    [[noreturn]] void ThrowParseError(std::string_view line, const std::string& message) const;
+};
@@ -0,0 +1,119 @@
+#include "daemon_common.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const int DEFAULT_PORT = 7700;
+const int LISTEN_BACKLOG = 1024;
+
+sockaddr_un MakeUnixAddress(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path \"" + path + "\" is too long.");
+    }
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path.c_str());
+    return address;
+}
+
+sockaddr_in MakeLoopbackAddress(int port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+[[noreturn]] void ThrowSystemError(const std::string& message, int fd) {
+    const std::string error = std::strerror(errno);
+    if (fd >= 0) {
+        close(fd);
+    }
+    throw std::runtime_error(message + ": " + error + ".");
+}
+
+} // namespace
+
+std::map<std::string, std::string> ParseOptions(int argc, char** argv) {
+    std::map<std::string, std::string> options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string name = argv[i];
+        if (name.size() < 3 || name.substr(0, 2) != "--" || i + 1 == argc) {
+            throw std::invalid_argument("Expected \"--name value\" arguments, got \"" + name + "\".");
+        }
+        options[name.substr(2)] = argv[++i];
+    }
+    return options;
+}
+
+Endpoint GetEndpoint(const std::map<std::string, std::string>& options) {
+    Endpoint endpoint;
+    if (options.count("socket")) {
+        endpoint.socket_path = options.at("socket");
+    }
+    else {
+        endpoint.port = options.count("port") ? std::stoi(options.at("port")) : DEFAULT_PORT;
+    }
+    return endpoint;
+}
+
+int Listen(const Endpoint& endpoint) {
+    int fd = -1;
+    if (!endpoint.socket_path.empty()) {
+        const sockaddr_un address = MakeUnixAddress(endpoint.socket_path);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            ThrowSystemError("Cannot create socket", fd);
+        }
+        unlink(endpoint.socket_path.c_str());
+        if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            ThrowSystemError("Cannot bind \"" + endpoint.socket_path + "\"", fd);
+        }
+    }
+    else {
+        const sockaddr_in address = MakeLoopbackAddress(endpoint.port);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            ThrowSystemError("Cannot create socket", fd);
+        }
+        const int enable = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            ThrowSystemError("Cannot bind port " + std::to_string(endpoint.port), fd);
+        }
+    }
+    if (listen(fd, LISTEN_BACKLOG) != 0) {
+        ThrowSystemError("Cannot listen", fd);
+    }
+    return fd;
+}
+
+int Connect(const Endpoint& endpoint) {
+    int fd = -1;
+    int result = -1;
+    if (!endpoint.socket_path.empty()) {
+        const sockaddr_un address = MakeUnixAddress(endpoint.socket_path);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        result = fd < 0 ? -1 : connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    }
+    else {
+        const sockaddr_in address = MakeLoopbackAddress(endpoint.port);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        result = fd < 0 ? -1 : connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        if (result == 0) {
+            const int enable = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+    }
+    if (result != 0) {
+        ThrowSystemError("Cannot connect", fd);
+    }
+    return fd;
+}
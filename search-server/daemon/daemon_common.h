@@ -0,0 +1,26 @@
+#pragma once
+#include <map>
+#include <string>
+
+// Общий код демона и генератора нагрузки. Протокол текстовый, по одному запросу на строку:
+//   FIND <query>              -> OK <id>:<relevance>:<rating> ...
+//   MATCH <document_id> <query> -> OK <status> <word> ...
+// при ошибке сервер отвечает строкой ERROR <message>. Ответы на запросы одного соединения
+// приходят в порядке запросов.
+
+const size_t MAX_REQUEST_LENGTH = 1 << 16;
+
+// Аргументы вида --name value
+std::map<std::string, std::string> ParseOptions(int argc, char** argv);
+
+// --socket <path> задаёт Unix domain socket, иначе используется loopback TCP на --port
+struct Endpoint {
+    std::string socket_path;
+    int port = 0;
+};
+
+Endpoint GetEndpoint(const std::map<std::string, std::string>& options);
+
+int Listen(const Endpoint& endpoint);
+
+int Connect(const Endpoint& endpoint);
@@ -0,0 +1,165 @@
+#include "daemon_common.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ConnectionStats {
+    std::vector<int64_t> latencies_us;
+    int error_count = 0;
+};
+
+std::vector<std::string> ReadQueries(const std::map<std::string, std::string>& options) {
+    if (!options.count("queries")) {
+        return { "curly nasty cat", "white cat", "nasty dog", "big eyes -dog", "yellow hat" };
+    }
+    std::ifstream input(options.at("queries"));
+    if (!input) {
+        throw std::runtime_error("Cannot open queries file \"" + options.at("queries") + "\".");
+    }
+    std::vector<std::string> queries;
+    for (std::string query; std::getline(input, query);) {
+        if (!query.empty()) {
+            queries.push_back(query);
+        }
+    }
+    if (queries.empty()) {
+        throw std::invalid_argument("Queries file is empty.");
+    }
+    return queries;
+}
+
+void SendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t size = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (size <= 0) {
+            throw std::runtime_error("Send failed.");
+        }
+        sent += size;
+    }
+}
+
+// Держит pipeline_depth запросов в полёте и отправляет следующий сразу после получения ответа
+ConnectionStats RunConnection(const Endpoint& endpoint, const std::vector<std::string>& queries,
+    size_t first_query, int request_count, int pipeline_depth) {
+    ConnectionStats stats;
+    stats.latencies_us.reserve(request_count);
+    const int fd = Connect(endpoint);
+    std::deque<Clock::time_point> send_times;
+    std::string input;
+    char buffer[1 << 16];
+    int sent_count = 0;
+    size_t query_index = first_query;
+
+    auto send_next = [&] {
+        SendAll(fd, "FIND " + queries[query_index++ % queries.size()] + "\n");
+        send_times.push_back(Clock::now());
+        ++sent_count;
+    };
+    while (sent_count < std::min(pipeline_depth, request_count)) {
+        send_next();
+    }
+    while (!send_times.empty()) {
+        const ssize_t size = recv(fd, buffer, sizeof(buffer), 0);
+        if (size <= 0) {
+            close(fd);
+            throw std::runtime_error("Connection closed by server.");
+        }
+        input.append(buffer, size);
+        size_t begin = 0;
+        for (size_t end = input.find('\n'); end != input.npos; end = input.find('\n', begin)) {
+            const auto latency = Clock::now() - send_times.front();
+            send_times.pop_front();
+            stats.latencies_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+            if (input.compare(begin, 5, "ERROR") == 0) {
+                ++stats.error_count;
+            }
+            begin = end + 1;
+            if (sent_count < request_count) {
+                send_next();
+            }
+        }
+        input.erase(0, begin);
+    }
+    close(fd);
+    return stats;
+}
+
+int64_t GetPercentile(const std::vector<int64_t>& sorted_values, double percentile) {
+    if (sorted_values.empty()) {
+        return 0;
+    }
+    const auto index = static_cast<size_t>(percentile / 100.0 * (sorted_values.size() - 1));
+    return sorted_values[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const auto options = ParseOptions(argc, argv);
+        const Endpoint endpoint = GetEndpoint(options);
+        const std::vector<std::string> queries = ReadQueries(options);
+        const int connection_count = options.count("connections") ? std::stoi(options.at("connections")) : 8;
+        const int request_count = options.count("requests") ? std::stoi(options.at("requests")) : 100000;
+        const int pipeline_depth = options.count("pipeline") ? std::stoi(options.at("pipeline")) : 1;
+        if (connection_count <= 0 || request_count <= 0 || pipeline_depth <= 0) {
+            throw std::invalid_argument("--connections, --requests and --pipeline must be positive.");
+        }
+
+        std::vector<ConnectionStats> stats(connection_count);
+        std::vector<std::thread> threads;
+        const auto start = Clock::now();
+        for (int i = 0; i < connection_count; ++i) {
+            const int connection_requests = request_count / connection_count + (i < request_count % connection_count);
+            threads.emplace_back([&, i, connection_requests] {
+                try {
+                    stats[i] = RunConnection(endpoint, queries, i, connection_requests, pipeline_depth);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "Connection " << i << ": " << e.what() << std::endl;
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::vector<int64_t> latencies_us;
+        int error_count = 0;
+        for (const ConnectionStats& connection_stats : stats) {
+            latencies_us.insert(latencies_us.end(), connection_stats.latencies_us.begin(), connection_stats.latencies_us.end());
+            error_count += connection_stats.error_count;
+        }
+        std::sort(latencies_us.begin(), latencies_us.end());
+
+        std::cout << std::fixed << std::setprecision(1)
+            << "requests: " << latencies_us.size() << ", errors: " << error_count
+            << ", time: " << seconds << " s, QPS: " << latencies_us.size() / seconds << '\n'
+            << "latency us: p50 " << GetPercentile(latencies_us, 50)
+            << ", p90 " << GetPercentile(latencies_us, 90)
+            << ", p99 " << GetPercentile(latencies_us, 99)
+            << ", p99.9 " << GetPercentile(latencies_us, 99.9)
+            << ", max " << (latencies_us.empty() ? 0 : latencies_us.back()) << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "request_handler.h"
+#include <charconv>
+#include <sstream>
+
+namespace {
+
+std::string_view GetStatusName(DocumentStatus status) {
+    switch (status) {
+    case DocumentStatus::ACTUAL: return "ACTUAL";
+    case DocumentStatus::IRRELEVANT: return "IRRELEVANT";
+    case DocumentStatus::BANNED: return "BANNED";
+    case DocumentStatus::REMOVED: return "REMOVED";
+    }
+    return "UNKNOWN";
+}
+
+std::string HandleFind(const SearchServer& search_server, std::string_view query) {
+    std::ostringstream response;
+    response << "OK";
+    for (const Document& document : search_server.FindTopDocuments(query)) {
+        response << ' ' << document.id << ':' << document.relevance << ':' << document.rating;
+    }
+    return response.str();
+}
+
+std::string HandleMatch(const SearchServer& search_server, std::string_view arguments) {
+    int document_id = 0;
+    const auto [ptr, error] = std::from_chars(arguments.data(), arguments.data() + arguments.size(), document_id);
+    if (error != std::errc{} || ptr == arguments.data() + arguments.size() || *ptr != ' ') {
+        return "ERROR expected MATCH <document_id> <query>";
+    }
+    arguments.remove_prefix(ptr - arguments.data() + 1);
+    if (!search_server.HasDocument(document_id)) {
+        return "ERROR unknown document";
+    }
+    const auto [words, status] = search_server.MatchDocument(arguments, document_id);
+    std::string response = "OK ";
+    response += GetStatusName(status);
+    for (std::string_view word : words) {
+        response += ' ';
+        response += word;
+    }
+    return response;
+}
+
+} // namespace
+
+std::string HandleRequest(const SearchServer& search_server, std::string_view request) {
+    const std::string_view find_command = "FIND ";
+    const std::string_view match_command = "MATCH ";
+    try {
+        if (request.substr(0, find_command.size()) == find_command) {
+            return HandleFind(search_server, request.substr(find_command.size()));
+        }
+        if (request.substr(0, match_command.size()) == match_command) {
+            return HandleMatch(search_server, request.substr(match_command.size()));
+        }
+        return "ERROR unknown command";
+    }
+    catch (const std::exception& e) {
+        return std::string{ "ERROR " } + e.what();
+    }
+}
+
+std::vector<std::string> HandleRequests(const SearchServer& search_server, const std::vector<std::string>& requests) {
+    std::vector<std::string> responses(requests.size());
+    std::transform(std::execution::par, requests.begin(), requests.end(), responses.begin(),
+        [&search_server](const std::string& request) { return HandleRequest(search_server, request); });
+    return responses;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../search_server.h"
+
+std::string HandleRequest(const SearchServer& search_server, std::string_view request);
+
+// Выполняет пачку запросов параллельно, как ProcessQueries
+std::vector<std::string> HandleRequests(const SearchServer& search_server, const std::vector<std::string>& requests);
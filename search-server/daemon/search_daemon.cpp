@@ -0,0 +1,490 @@
+#include "daemon_common.h"
+#include "request_handler.h"
+#include "../corpus_loader.h"
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+const size_t MAX_BATCH_SIZE = 32;
+const int MAX_EVENTS = 256;
+const size_t READ_BUFFER_SIZE = 1 << 16;
+// Пока у соединения столько запросов без отправленного ответа или столько неотправленных байт,
+// из него ничего не читается: клиент, который не забирает ответы, не может занять всю память
+const uint64_t MAX_IN_FLIGHT_REQUESTS = 256;
+const size_t MAX_OUTPUT_SIZE = 1 << 20;
+
+const uint64_t LISTEN_ID = 0;
+const uint64_t WAKEUP_ID = 1;
+const uint64_t SIGNAL_ID = 2;
+const uint64_t FIRST_CONNECTION_ID = 3;
+
+struct Request {
+    uint64_t connection_id;
+    uint64_t sequence;
+    std::string text;
+};
+
+struct Response {
+    uint64_t connection_id;
+    uint64_t sequence;
+    std::string text;
+};
+
+[[noreturn]] void ThrowSystemError(const std::string& message) {
+    throw std::runtime_error(message + ": " + std::strerror(errno) + ".");
+}
+
+// Обработчик забирает все накопившиеся запросы, но не больше MAX_BATCH_SIZE,
+// так что под нагрузкой запросы разных соединений сами собираются в пачки
+class BatchQueue {
+public:
+    void Push(std::vector<Request>& requests) {
+        {
+            std::lock_guard guard(mutex_);
+            std::move(requests.begin(), requests.end(), std::back_inserter(requests_));
+        }
+        requests.clear();
+        condition_.notify_all();
+    }
+
+    // Возвращает false, когда очередь закрыта и пуста
+    bool PopBatch(std::vector<Request>& batch) {
+        std::unique_lock lock(mutex_);
+        condition_.wait(lock, [this] { return is_closed_ || !requests_.empty(); });
+        if (requests_.empty()) {
+            return false;
+        }
+        batch.clear();
+        while (!requests_.empty() && batch.size() < MAX_BATCH_SIZE) {
+            batch.push_back(std::move(requests_.front()));
+            requests_.pop_front();
+        }
+        return true;
+    }
+
+    void Close() {
+        {
+            std::lock_guard guard(mutex_);
+            is_closed_ = true;
+        }
+        condition_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<Request> requests_;
+    bool is_closed_ = false;
+};
+
+// Готовые ответы от обработчиков; цикл событий будится через eventfd
+class CompletionQueue {
+public:
+    explicit CompletionQueue(int event_fd)
+        : event_fd_(event_fd) {
+    }
+
+    void Push(std::vector<Response>& responses) {
+        {
+            std::lock_guard guard(mutex_);
+            std::move(responses.begin(), responses.end(), std::back_inserter(responses_));
+        }
+        responses.clear();
+        const uint64_t one = 1;
+        [[maybe_unused]] const auto written = write(event_fd_, &one, sizeof(one));
+    }
+
+    std::vector<Response> PopAll() {
+        uint64_t counter = 0;
+        [[maybe_unused]] const auto read_size = read(event_fd_, &counter, sizeof(counter));
+        std::vector<Response> result;
+        std::lock_guard guard(mutex_);
+        result.swap(responses_);
+        return result;
+    }
+
+private:
+    const int event_fd_;
+    std::mutex mutex_;
+    std::vector<Response> responses_;
+};
+
+struct Connection {
+    int fd;
+    std::string input;
+    std::string output;
+    uint64_t next_sequence = 0;
+    uint64_t next_sequence_to_send = 0;
+    // ответы, пришедшие раньше ответов на предыдущие запросы соединения
+    std::map<uint64_t, std::string> ready_responses;
+    uint32_t watched_events = EPOLLIN;
+    // клиент закрыл свою сторону; соединение закрывается после отправки всех ответов
+    bool is_input_closed = false;
+
+    bool IsSaturated() const {
+        return next_sequence - next_sequence_to_send >= MAX_IN_FLIGHT_REQUESTS
+            || output.size() >= MAX_OUTPUT_SIZE;
+    }
+};
+
+class SearchDaemon {
+public:
+    SearchDaemon(const SearchServer& search_server, int listen_fd, bool is_tcp, size_t worker_count);
+    ~SearchDaemon();
+
+    SearchDaemon(const SearchDaemon&) = delete;
+    SearchDaemon& operator=(const SearchDaemon&) = delete;
+
+    // Обслуживает соединения до SIGINT или SIGTERM
+    void Run();
+
+private:
+    const SearchServer& search_server_;
+    const int listen_fd_;
+    const bool is_tcp_;
+    int epoll_fd_ = -1;
+    int wakeup_fd_ = -1;
+    int signal_fd_ = -1;
+    BatchQueue batch_queue_;
+    std::unique_ptr<CompletionQueue> completion_queue_;
+    std::vector<std::thread> workers_;
+    std::unordered_map<uint64_t, Connection> connections_;
+    uint64_t next_connection_id_ = FIRST_CONNECTION_ID;
+    std::vector<Request> pending_requests_;
+
+    void Watch(int fd, uint64_t id, uint32_t events, int operation);
+    void AcceptConnections();
+    void ReadRequests(uint64_t connection_id);
+    bool ParseRequests(Connection& connection, uint64_t connection_id);
+    void DeliverResponses();
+    void FlushOutput(uint64_t connection_id);
+    void UpdateWatch(uint64_t connection_id);
+    void CloseConnection(uint64_t connection_id);
+    void RunWorker();
+};
+
+SearchDaemon::SearchDaemon(const SearchServer& search_server, int listen_fd, bool is_tcp, size_t worker_count)
+    : search_server_(search_server)
+    , listen_fd_(listen_fd)
+    , is_tcp_(is_tcp)
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    signal_fd_ = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wakeup_fd_ < 0 || signal_fd_ < 0) {
+        ThrowSystemError("Cannot create event loop");
+    }
+    completion_queue_ = std::make_unique<CompletionQueue>(wakeup_fd_);
+    Watch(listen_fd_, LISTEN_ID, EPOLLIN, EPOLL_CTL_ADD);
+    Watch(wakeup_fd_, WAKEUP_ID, EPOLLIN, EPOLL_CTL_ADD);
+    Watch(signal_fd_, SIGNAL_ID, EPOLLIN, EPOLL_CTL_ADD);
+
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back([this] { RunWorker(); });
+    }
+}
+
+SearchDaemon::~SearchDaemon() {
+    batch_queue_.Close();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    for (const auto& [id, connection] : connections_) {
+        close(connection.fd);
+    }
+    for (int fd : { signal_fd_, wakeup_fd_, epoll_fd_, listen_fd_ }) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+void SearchDaemon::Run() {
+    std::vector<epoll_event> events(MAX_EVENTS);
+    bool is_running = true;
+    while (is_running) {
+        const int event_count = epoll_wait(epoll_fd_, events.data(), MAX_EVENTS, -1);
+        if (event_count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("epoll_wait failed");
+        }
+        for (int i = 0; i < event_count; ++i) {
+            const uint64_t id = events[i].data.u64;
+            if (id == LISTEN_ID) {
+                AcceptConnections();
+            }
+            else if (id == WAKEUP_ID) {
+                DeliverResponses();
+            }
+            else if (id == SIGNAL_ID) {
+                is_running = false;
+            }
+            else {
+                const auto it = connections_.find(id);
+                if (it == connections_.end()) {
+                    continue;
+                }
+                // EPOLLHUP приходит, только когда ответы уже некуда отправить
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    CloseConnection(id);
+                    continue;
+                }
+                if (events[i].events & EPOLLIN) {
+                    ReadRequests(id);
+                }
+                if ((events[i].events & EPOLLOUT) && connections_.count(id)) {
+                    FlushOutput(id);
+                }
+            }
+        }
+        // все запросы, прочитанные за одну итерацию, уходят обработчикам одной порцией
+        if (!pending_requests_.empty()) {
+            batch_queue_.Push(pending_requests_);
+        }
+    }
+}
+
+void SearchDaemon::Watch(int fd, uint64_t id, uint32_t events, int operation) {
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = id;
+    if (epoll_ctl(epoll_fd_, operation, fd, &event) != 0) {
+        ThrowSystemError("epoll_ctl failed");
+    }
+}
+
+void SearchDaemon::AcceptConnections() {
+    while (true) {
+        const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        if (is_tcp_) {
+            const int enable = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+        const uint64_t id = next_connection_id_++;
+        connections_[id].fd = fd;
+        Watch(fd, id, EPOLLIN, EPOLL_CTL_ADD);
+    }
+}
+
+void SearchDaemon::ReadRequests(uint64_t connection_id) {
+    Connection& connection = connections_.at(connection_id);
+    char buffer[READ_BUFFER_SIZE];
+    while (!connection.IsSaturated()) {
+        const ssize_t size = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (size > 0) {
+            connection.input.append(buffer, size);
+            if (!ParseRequests(connection, connection_id)) {
+                CloseConnection(connection_id);
+                return;
+            }
+            continue;
+        }
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (size < 0) {
+            CloseConnection(connection_id);
+            return;
+        }
+        connection.is_input_closed = true;
+        break;
+    }
+    FlushOutput(connection_id);
+}
+
+// Разбирает полные строки из входного буфера, пока соединение не упрётся в ограничения;
+// остаток разбирается после отправки ответов.
+// Возвращает false, если клиент прислал запрос длиннее MAX_REQUEST_LENGTH и соединение нужно закрыть
+bool SearchDaemon::ParseRequests(Connection& connection, uint64_t connection_id) {
+    size_t begin = 0;
+    for (size_t end = connection.input.find('\n'); end != connection.input.npos && !connection.IsSaturated();
+        end = connection.input.find('\n', begin)) {
+        if (end - begin > MAX_REQUEST_LENGTH) {
+            return false;
+        }
+        std::string_view line(connection.input.data() + begin, end - begin);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        pending_requests_.push_back({ connection_id, connection.next_sequence++, std::string{ line } });
+        begin = end + 1;
+    }
+    connection.input.erase(0, begin);
+    // незаконченная строка в конце буфера
+    const size_t last_line_end = connection.input.rfind('\n');
+    const size_t tail_length = last_line_end == connection.input.npos
+        ? connection.input.size() : connection.input.size() - last_line_end - 1;
+    return tail_length <= MAX_REQUEST_LENGTH;
+}
+
+void SearchDaemon::DeliverResponses() {
+    std::set<uint64_t> touched_connections;
+    for (Response& response : completion_queue_->PopAll()) {
+        const auto it = connections_.find(response.connection_id);
+        if (it == connections_.end()) {
+            continue;
+        }
+        Connection& connection = it->second;
+        connection.ready_responses[response.sequence] = std::move(response.text);
+        while (!connection.ready_responses.empty()
+            && connection.ready_responses.begin()->first == connection.next_sequence_to_send) {
+            connection.output += connection.ready_responses.begin()->second;
+            connection.output += '\n';
+            connection.ready_responses.erase(connection.ready_responses.begin());
+            ++connection.next_sequence_to_send;
+        }
+        touched_connections.insert(response.connection_id);
+    }
+    for (uint64_t connection_id : touched_connections) {
+        FlushOutput(connection_id);
+    }
+}
+
+void SearchDaemon::FlushOutput(uint64_t connection_id) {
+    Connection& connection = connections_.at(connection_id);
+    size_t sent = 0;
+    while (sent < connection.output.size()) {
+        const ssize_t size = send(connection.fd, connection.output.data() + sent,
+            connection.output.size() - sent, MSG_NOSIGNAL);
+        if (size > 0) {
+            sent += size;
+            continue;
+        }
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        CloseConnection(connection_id);
+        return;
+    }
+    connection.output.erase(0, sent);
+    if (!ParseRequests(connection, connection_id)) {
+        CloseConnection(connection_id);
+        return;
+    }
+    if (connection.is_input_closed && connection.output.empty()
+        && connection.next_sequence_to_send == connection.next_sequence) {
+        CloseConnection(connection_id);
+        return;
+    }
+    UpdateWatch(connection_id);
+}
+
+void SearchDaemon::UpdateWatch(uint64_t connection_id) {
+    Connection& connection = connections_.at(connection_id);
+    const uint32_t events = (connection.is_input_closed || connection.IsSaturated() ? 0u : EPOLLIN)
+        | (connection.output.empty() ? 0u : EPOLLOUT);
+    if (events != connection.watched_events) {
+        Watch(connection.fd, connection_id, events, EPOLL_CTL_MOD);
+        connection.watched_events = events;
+    }
+}
+
+void SearchDaemon::CloseConnection(uint64_t connection_id) {
+    close(connections_.at(connection_id).fd);
+    connections_.erase(connection_id);
+}
+
+void SearchDaemon::RunWorker() {
+    std::vector<Request> batch;
+    std::vector<std::string> texts;
+    std::vector<Response> responses;
+    while (batch_queue_.PopBatch(batch)) {
+        texts.clear();
+        for (Request& request : batch) {
+            texts.push_back(std::move(request.text));
+        }
+        std::vector<std::string> results = HandleRequests(search_server_, texts);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            responses.push_back({ batch[i].connection_id, batch[i].sequence, std::move(results[i]) });
+        }
+        completion_queue_->Push(responses);
+    }
+}
+
+CorpusFormat GetCorpusFormat(const std::map<std::string, std::string>& options) {
+    if (!options.count("format") || options.at("format") == "tsv") {
+        return CorpusFormat::TSV;
+    }
+    if (options.at("format") == "jsonl") {
+        return CorpusFormat::JSONL;
+    }
+    throw std::invalid_argument("Unknown corpus format \"" + options.at("format") + "\".");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const auto options = ParseOptions(argc, argv);
+        if (!options.count("corpus")) {
+            std::cerr << "Usage: search_daemon --corpus <file> [--format tsv|jsonl] [--stop-words \"a b\"] [--patterns wildcard]"
+                " [--socket <path> | --port <port>] [--workers <count>]" << std::endl;
+            return 1;
+        }
+        SearchServer search_server(options.count("stop-words") ? options.at("stop-words") : std::string{});
+        if (options.count("patterns") && options.at("patterns") == "wildcard") {
+            search_server.SetPatternMode(PatternMode::WILDCARD);
+        }
+        Corpus corpus(options.at("corpus"), GetCorpusFormat(options));
+        const int document_count = corpus.LoadInto(search_server);
+
+        const int worker_count = options.count("workers")
+            ? std::stoi(options.at("workers"))
+            : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        if (worker_count < 1) {
+            throw std::invalid_argument("Number of workers must be at least 1.");
+        }
+        const Endpoint endpoint = GetEndpoint(options);
+        {
+            SearchDaemon daemon(search_server, Listen(endpoint), endpoint.socket_path.empty(), worker_count);
+            std::cerr << "Loaded " << document_count << " documents, serving on "
+                << (endpoint.socket_path.empty() ? "127.0.0.1:" + std::to_string(endpoint.port) : endpoint.socket_path)
+                << " with " << worker_count << " workers" << std::endl;
+            daemon.Run();
+        }
+        if (!endpoint.socket_path.empty()) {
+            unlink(endpoint.socket_path.c_str());
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
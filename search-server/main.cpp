@@ -1,5 +1,6 @@
 #include "process_queries.h"
 #include "search_server.h"
+#include "test_example_functions.h"
 #include <execution>
 #include <iostream>
 #include <string>
@@ -11,7 +12,13 @@ void PrintDocument(const Document& document) {
          << "relevance = "s << document.relevance << ", "s
          << "rating = "s << document.rating << " }"s << endl;
 }
-int main() {
+int main(int argc, char** argv) {
+    TestSearchServer();
+    // ./search_server --benchmark [term_count]
+    if (argc > 1 && argv[1] == "--benchmark"s) {
+        BenchmarkPatternExpansion(argc > 2 ? stoi(argv[2]) : 3'000'000);
+        return 0;
+    }
     SearchServer search_server("and with"s);
     int id = 0;
     for (
@@ -0,0 +1,36 @@
+#include "position_list.h"
+
+void PositionList::Add(uint32_t position) {
+    uint32_t delta = size_ == 0 ? position : position - last_position_;
+    while (delta >= 0x80) {
+        data_.push_back(static_cast<uint8_t>(delta | 0x80));
+        delta >>= 7;
+    }
+    data_.push_back(static_cast<uint8_t>(delta));
+    last_position_ = position;
+    ++size_;
+}
+
+std::vector<uint32_t> PositionList::Decode() const {
+    std::vector<uint32_t> positions;
+    positions.reserve(size_);
+    uint32_t position = 0;
+    uint32_t delta = 0;
+    int shift = 0;
+    for (uint8_t byte : data_) {
+        delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (byte & 0x80) {
+            shift += 7;
+            continue;
+        }
+        position += delta;
+        positions.push_back(position);
+        delta = 0;
+        shift = 0;
+    }
+    return positions;
+}
+
+size_t PositionList::Size() const {
+    return size_;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Сжатый список позиций слова в документе: дельты между соседними позициями в формате varint
+class PositionList {
+public:
+    // позиции должны добавляться по возрастанию
+    void Add(uint32_t position);
+
+    std::vector<uint32_t> Decode() const;
+
+    size_t Size() const;
+
+private:
+    std::vector<uint8_t> data_;
+    uint32_t last_position_ = 0;
+    size_t size_ = 0;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <cmath>
+
+// Модели ранжирования для SearchServer::FindTopDocuments<ScoringModel>.
+// IDF считается один раз на слово запроса, норма длины и ComputeScore - для каждой пары
+// (слово, документ), поэтому они должны быть дешёвыми.
+struct TfIdfScoring {
+    static double ComputeInverseDocumentFreq(int document_count, int document_freq) {
+        return std::log(document_count * 1.0 / document_freq);
+    }
+
+    static double ComputeLengthNorm(int document_length, double /*average_length*/) {
+        return 1.0 / document_length;
+    }
+
+    static double ComputeScore(int term_count, double inverse_document_freq, double length_norm) {
+        return term_count * length_norm * inverse_document_freq;
+    }
+};
+
+struct Bm25Scoring {
+    static constexpr double K1 = 1.2;
+    static constexpr double B = 0.75;
+
+    static double ComputeInverseDocumentFreq(int document_count, int document_freq) {
+        return std::log(1.0 + (document_count - document_freq + 0.5) / (document_freq + 0.5));
+    }
+
+    static double ComputeLengthNorm(int document_length, double average_length) {
+        return K1 * (1.0 - B + B * document_length / average_length);
+    }
+
+    static double ComputeScore(int term_count, double inverse_document_freq, double length_norm) {
+        return inverse_document_freq * term_count * (K1 + 1.0) / (term_count + length_norm);
+    }
+};
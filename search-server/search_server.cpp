@@ -1,13 +1,25 @@
 #include "search_server.h"
 
-SearchServer::SearchServer(std::string_view stop_words_text)
-    : SearchServer(SplitIntoWords(stop_words_text))
+SearchServer::SearchServer(std::string_view stop_words_text, IndexMode index_mode)
+    : SearchServer(SplitIntoWords(stop_words_text), index_mode)
 {
 }
-SearchServer::SearchServer(const std::string& stop_words_text)
-    : SearchServer(SplitIntoWords(std::string_view{ stop_words_text }))
+SearchServer::SearchServer(const std::string& stop_words_text, IndexMode index_mode)
+    : SearchServer(SplitIntoWords(std::string_view{ stop_words_text }), index_mode)
 {
 }
+
+void SearchServer::SetRankingMode(RankingMode ranking_mode) {
+    if (ranking_mode == RankingMode::PROXIMITY && index_mode_ != IndexMode::POSITIONAL) {
+        throw std::logic_error("Proximity ranking requires positional index.");
+    }
+    ranking_mode_ = ranking_mode;
+}
+
+void SearchServer::SetPatternMode(PatternMode pattern_mode) {
+    pattern_mode_ = pattern_mode;
+}
+
 void SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status,
     const std::vector<int>& ratings) {
     if (document_id < 0)
@@ -19,19 +31,31 @@ void SearchServer::AddDocument(int document_id, std::string_view document, Docum
         throw std::invalid_argument("Unacceptable id. This id is already used.");
     }
     std::vector<std::string_view> words = SplitIntoWordsNoStop(document);
-    const double inv_word_count = 1.0 / words.size();
+    std::vector<std::string_view> new_words;
     for (std::string_view word : words) {
         std::string str_word{ word };
         if (!server_words_.count(str_word)) {
             server_words_[str_word].first = str_word;
             std::string_view ptr_word{ server_words_.at(str_word).first };
             server_words_.at(str_word).second = ptr_word;
+            new_words.push_back(ptr_word);
         }
-        word_to_document_freqs_[server_words_.at(str_word).second][document_id] += inv_word_count;
-        id_words_freqs_[document_id][server_words_.at(str_word).second] += inv_word_count;
+        ++word_to_document_counts_[server_words_.at(str_word).second][document_id];
+        ++id_words_counts_[document_id][server_words_.at(str_word).second];
     }
-    documents_.emplace(document_id, DocumentData{ ComputeAverageRating(ratings), status, document });
+    term_dictionary_.Insert(std::move(new_words));
+    if (index_mode_ == IndexMode::POSITIONAL) {
+        uint32_t position = 0;
+        for (std::string_view word : SplitIntoWords(document)) {
+            if (!IsStopWord(word)) {
+                word_to_document_positions_[server_words_.at(std::string{ word }).second][document_id].Add(position);
+            }
+            ++position;
+        }
+    }
+    documents_.emplace(document_id, DocumentData{ ComputeAverageRating(ratings), status, document, static_cast<int>(words.size()) });
     index_id_.insert(document_id);
+    total_word_count_ += words.size();
 }
 
 std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status) const {
@@ -49,6 +73,10 @@ int SearchServer::GetDocumentCount() const {
     return documents_.size();
 }
 
+bool SearchServer::HasDocument(int document_id) const {
+    return documents_.count(document_id) > 0;
+}
+
 using MatchDocument_Type = std::tuple<std::vector<std::string_view>, DocumentStatus>;
 
 MatchDocument_Type SearchServer::MatchDocument(std::string_view raw_query,
@@ -57,19 +85,31 @@ MatchDocument_Type SearchServer::MatchDocument(std::string_view raw_query,
     const Query query = ParseQuery(raw_query, false);
     std::vector<std::string_view> matched_words;
     if (!index_id_.count(document_id)) {
-        return { {}, {} };
+        return { std::vector<std::string_view>{}, DocumentStatus{} };
+    }
+    //    -    id_words_counts_
+    if (!id_words_counts_.count(document_id)) {
+        return { std::vector<std::string_view>{}, documents_.at(document_id).status };
     }
     for (std::string_view word : query.plus_words) {
-        if (id_words_freqs_.at(document_id).count(word)) {
+        if (id_words_counts_.at(document_id).count(word)) {
             matched_words.push_back(word);
         }
     }
-    for (std::string_view word : query.minus_words) {
-        if (id_words_freqs_.at(document_id).count(word)) {
-            matched_words.clear();
-            break;
+    for (const auto& words : query.expanded_words) {
+        for (std::string_view word : words) {
+            if (id_words_counts_.at(document_id).count(word)) {
+                matched_words.push_back(word);
+            }
         }
     }
+    if (!query.expanded_words.empty()) {
+        std::sort(matched_words.begin(), matched_words.end());
+        matched_words.erase(std::unique(matched_words.begin(), matched_words.end()), matched_words.end());
+    }
+    if (HasMinusWords(query, document_id) || !MatchesPhrases(query, document_id)) {
+        matched_words.clear();
+    }
     MatchDocument_Type result = { matched_words, documents_.at(document_id).status };
     return result;
 }
@@ -85,23 +125,35 @@ MatchDocument_Type SearchServer::MatchDocument(const std::execution::parallel_po
     //-------------------------------------------
     const Query query = ParseQuery(raw_query, true);
     if (!index_id_.count(document_id)) {
-        return { {}, {} };
+        return { std::vector<std::string_view>{}, DocumentStatus{} };
+    }
+    //    -    id_words_counts_
+    if (!id_words_counts_.count(document_id)) {
+        return { std::vector<std::string_view>{}, documents_.at(document_id).status };
     }
     if (std::any_of(std::execution::par,
         query.minus_words.begin(), query.minus_words.end(),
         [&](std::string_view str)
-        { return id_words_freqs_.at(document_id).count(str); })) {
-        return { {}, documents_.at(document_id).status };
+        { return id_words_counts_.at(document_id).count(str); })
+        || !MatchesPhrases(query, document_id)) {
+        return { std::vector<std::string_view>{}, documents_.at(document_id).status };
     }
     std::vector<std::string_view> matched_words(query.plus_words.size());
     auto it_end = std::copy_if(std::execution::par,
         query.plus_words.begin(), query.plus_words.end(),
         matched_words.begin(),
         [&](std::string_view str) {
-            return id_words_freqs_.at(document_id).count(str);
+            return id_words_counts_.at(document_id).count(str);
         });
-    std::sort(std::execution::par, matched_words.begin(), it_end);
-    it_end = std::unique(std::execution::par, matched_words.begin(), it_end);
+    matched_words.erase(it_end, matched_words.end());
+    for (const auto& words : query.expanded_words) {
+        std::copy_if(words.begin(), words.end(), std::back_inserter(matched_words),
+            [&](std::string_view str) {
+                return id_words_counts_.at(document_id).count(str);
+            });
+    }
+    std::sort(std::execution::par, matched_words.begin(), matched_words.end());
+    it_end = std::unique(std::execution::par, matched_words.begin(), matched_words.end());
     matched_words.erase(it_end, matched_words.end());
     return { matched_words, documents_.at(document_id).status };
 }
@@ -116,7 +168,12 @@ std::set <int> ::iterator SearchServer::end() {
 
 const std::map<std::string_view, double> SearchServer::GetWordFrequencies(int document_id) const {
     if (index_id_.count(document_id)) {
-        return id_words_freqs_.at(document_id);
+        const double inv_word_count = 1.0 / documents_.at(document_id).word_count;
+        std::map<std::string_view, double> word_freqs;
+        for (const auto [word, count] : id_words_counts_.at(document_id)) {
+            word_freqs.emplace(word, count * inv_word_count);
+        }
+        return word_freqs;
     }
     std::map<std::string_view, double> empty_result;
     return empty_result;
@@ -130,9 +187,9 @@ void SearchServer::RemoveDocument(const std::execution::sequenced_policy&, int d
     if (!index_id_.count(document_id)) {
         return;
     }
-    std::vector<std::string_view> words(id_words_freqs_.at(document_id).size());
+    std::vector<std::string_view> words(id_words_counts_.at(document_id).size());
     std::transform(std::execution::seq,
-        id_words_freqs_.at(document_id).begin(), id_words_freqs_.at(document_id).end(),
+        id_words_counts_.at(document_id).begin(), id_words_counts_.at(document_id).end(),
         words.begin(),
         [](auto& word_freq) {
             return word_freq.first;
@@ -141,20 +198,24 @@ void SearchServer::RemoveDocument(const std::execution::sequenced_policy&, int d
     std::for_each(std::execution::seq,
         words.begin(), words.end(),
         [&](std::string_view word) {
-            word_to_document_freqs_.at(word).erase(document_id);
+            word_to_document_counts_.at(word).erase(document_id);
+            if (index_mode_ == IndexMode::POSITIONAL) {
+                word_to_document_positions_.at(word).erase(document_id);
+            }
         });
+    total_word_count_ -= documents_.at(document_id).word_count;
     index_id_.erase(document_id);
     documents_.erase(document_id);
-    id_words_freqs_.erase(document_id);
+    id_words_counts_.erase(document_id);
 }
 
 void SearchServer::RemoveDocument(const std::execution::parallel_policy&, int document_id) {
     if (!index_id_.count(document_id)) {
         return;
     }
-    std::vector<std::string_view> words(id_words_freqs_.at(document_id).size());
+    std::vector<std::string_view> words(id_words_counts_.at(document_id).size());
     std::transform(std::execution::par,
-        id_words_freqs_.at(document_id).begin(), id_words_freqs_.at(document_id).end(),
+        id_words_counts_.at(document_id).begin(), id_words_counts_.at(document_id).end(),
         words.begin(),
         [](auto& word_freq) {
             return word_freq.first;
@@ -164,11 +225,15 @@ void SearchServer::RemoveDocument(const std::execution::parallel_policy&, int do
     std::for_each(std::execution::par,
         words.begin(), words.end(),
         [&](std::string_view word) {
-            word_to_document_freqs_.at(word).erase(document_id);
+            word_to_document_counts_.at(word).erase(document_id);
+            if (index_mode_ == IndexMode::POSITIONAL) {
+                word_to_document_positions_.at(word).erase(document_id);
+            }
         });
+    total_word_count_ -= documents_.at(document_id).word_count;
     index_id_.erase(document_id);
     documents_.erase(document_id);
-    id_words_freqs_.erase(document_id);
+    id_words_counts_.erase(document_id);
 }
 
 bool SearchServer::IsStopWord(std::string_view word) const {
@@ -213,7 +278,42 @@ SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) cons
 
 SearchServer::Query SearchServer::ParseQuery(std::string_view text, bool skip_sort) const {
     SearchServer::Query query;
+    bool in_phrase = false;
+    uint32_t phrase_offset = 0;
     for (std::string_view word : SplitIntoWords(text)) {
+        if (index_mode_ == IndexMode::POSITIONAL && (in_phrase || word[0] == '"')) {
+            if (!in_phrase) {
+                word.remove_prefix(1);
+                in_phrase = true;
+                phrase_offset = 0;
+                query.phrases.emplace_back();
+            }
+            else if (word[0] == '"') {
+                throw std::invalid_argument("Error in the word \"" + std::string{ word } +
+                    "\". Phrases can't be nested.");
+            }
+            const bool is_phrase_end = !word.empty() && word.back() == '"';
+            if (is_phrase_end) {
+                word.remove_suffix(1);
+            }
+            if (!word.empty()) {
+                if (!IsValidWord(word)) {
+                    throw std::invalid_argument("Unacceptable symbols in word \"" + std::string{ word } + "\".");
+                }
+                if (!IsStopWord(word)) {
+                    query.phrases.back().push_back({ word, phrase_offset });
+                    query.plus_words.push_back(word);
+                }
+                ++phrase_offset;
+            }
+            if (is_phrase_end) {
+                in_phrase = false;
+                if (query.phrases.back().empty()) {
+                    query.phrases.pop_back();
+                }
+            }
+            continue;
+        }
         if (!IsValidWord(word)) {
             throw std::invalid_argument("Unacceptable symbols in word \"" + std::string{ word } + "\".");
         }
@@ -224,7 +324,23 @@ SearchServer::Query SearchServer::ParseQuery(std::string_view text, bool skip_so
         if (word == "-") {
             throw std::invalid_argument("Unacceptable word \"" + std::string{ word } + "\".");
         }
+        if (index_mode_ == IndexMode::POSITIONAL && word[0] == '-' && word[1] == '"') {
+            throw std::invalid_argument("Error in the word \"" + std::string{ word } +
+                "\". Phrases can't be used as minus-words.");
+        }
         const QueryWord query_word = ParseQueryWord(word);
+        if (pattern_mode_ == PatternMode::WILDCARD && TermDictionary::IsPattern(query_word.data)) {
+            // -  ,          
+            std::vector<std::string_view> expanded_words = ExpandPattern(query_word.data,
+                query_word.is_minus ? std::numeric_limits<size_t>::max() : MAX_EXPANDED_TERMS);
+            if (query_word.is_minus) {
+                query.minus_words.insert(query.minus_words.end(), expanded_words.begin(), expanded_words.end());
+            }
+            else if (!expanded_words.empty()) {
+                query.expanded_words.push_back(std::move(expanded_words));
+            }
+            continue;
+        }
         if (!query_word.is_stop) {
             if (query_word.is_minus) {
                 query.minus_words.push_back(query_word.data);
@@ -234,6 +350,9 @@ SearchServer::Query SearchServer::ParseQuery(std::string_view text, bool skip_so
             }
         }
     }
+    if (in_phrase) {
+        throw std::invalid_argument("Unterminated phrase in query \"" + std::string{ text } + "\".");
+    }
     if (!skip_sort) {
         std::sort(query.minus_words.begin(), query.minus_words.end());
         auto it_minus = std::unique(query.minus_words.begin(), query.minus_words.end());
@@ -242,10 +361,130 @@ SearchServer::Query SearchServer::ParseQuery(std::string_view text, bool skip_so
         std::sort(query.plus_words.begin(), query.plus_words.end());
         auto it_plus = std::unique(query.plus_words.begin(), query.plus_words.end());
         query.plus_words.erase(it_plus, query.plus_words.end());
+
+        std::sort(query.expanded_words.begin(), query.expanded_words.end());
+        auto it_expanded = std::unique(query.expanded_words.begin(), query.expanded_words.end());
+        query.expanded_words.erase(it_expanded, query.expanded_words.end());
     }
     return query;
 }
 
-double SearchServer::ComputeWordInverseDocumentFreq(std::string_view word) const {
-    return log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
-}
\ No newline at end of file
+double SearchServer::ComputeAverageDocumentLength() const {
+    return documents_.empty() ? 0.0 : total_word_count_ * 1.0 / documents_.size();
+}
+
+std::vector<std::string_view> SearchServer::ExpandPattern(std::string_view pattern, size_t max_terms) const {
+    if (pattern[0] == '*' || pattern[0] == '?') {
+        throw std::invalid_argument("Pattern \"" + std::string{ pattern } + "\" must start with a letter.");
+    }
+    return term_dictionary_.Expand(pattern, max_terms,
+        [this](std::string_view word) {
+            const auto it = word_to_document_counts_.find(word);
+            return it != word_to_document_counts_.end() && !it->second.empty();
+        });
+}
+
+bool SearchServer::HasMinusWords(const Query& query, int document_id) const {
+    const auto& word_counts = id_words_counts_.at(document_id);
+    return std::any_of(query.minus_words.begin(), query.minus_words.end(),
+        [&](std::string_view word) {
+            return word_counts.count(word);
+        });
+}
+
+bool SearchServer::MatchesPhrase(const Phrase& phrase, int document_id) const {
+    std::vector<std::vector<uint32_t>> positions;
+    positions.reserve(phrase.size());
+    for (const PhraseWord& phrase_word : phrase) {
+        const auto it_word = word_to_document_positions_.find(phrase_word.data);
+        if (it_word == word_to_document_positions_.end()) {
+            return false;
+        }
+        const auto it_document = it_word->second.find(document_id);
+        if (it_document == it_word->second.end()) {
+            return false;
+        }
+        positions.push_back(it_document->second.Decode());
+    }
+    for (uint32_t position : positions[0]) {
+        if (position < phrase[0].offset) {
+            continue;
+        }
+        const uint32_t phrase_start = position - phrase[0].offset;
+        bool is_matched = true;
+        for (size_t i = 1; i < phrase.size() && is_matched; ++i) {
+            is_matched = std::binary_search(positions[i].begin(), positions[i].end(),
+                phrase_start + phrase[i].offset);
+        }
+        if (is_matched) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SearchServer::MatchesPhrases(const Query& query, int document_id) const {
+    return std::all_of(query.phrases.begin(), query.phrases.end(),
+        [&](const Phrase& phrase) {
+            return MatchesPhrase(phrase, document_id);
+        });
+}
+
+std::vector<int> SearchServer::FindPhraseCandidates(const Query& query) const {
+    std::vector<const std::map<int, int>*> postings;
+    for (const Phrase& phrase : query.phrases) {
+        for (const PhraseWord& phrase_word : phrase) {
+            const auto it = word_to_document_counts_.find(phrase_word.data);
+            if (it == word_to_document_counts_.end()) {
+                return {};
+            }
+            postings.push_back(&it->second);
+        }
+    }
+    std::sort(postings.begin(), postings.end());
+    postings.erase(std::unique(postings.begin(), postings.end()), postings.end());
+    std::sort(postings.begin(), postings.end(),
+        [](const auto* lhs, const auto* rhs) {
+            return lhs->size() < rhs->size();
+        });
+
+    std::vector<int> candidates;
+    candidates.reserve(postings[0]->size());
+    for (const auto [document_id, _] : *postings[0]) {
+        if (std::all_of(postings.begin() + 1, postings.end(),
+            [document_id = document_id](const auto* posting) {
+                return posting->count(document_id);
+            })) {
+            candidates.push_back(document_id);
+        }
+    }
+    return candidates;
+}
+
+double SearchServer::ComputeProximityBoost(const std::vector<std::string_view>& words, int document_id) const {
+    std::vector<std::pair<uint32_t, size_t>> positions;
+    for (size_t i = 0; i < words.size(); ++i) {
+        const auto it_word = word_to_document_positions_.find(words[i]);
+        if (it_word == word_to_document_positions_.end()) {
+            continue;
+        }
+        const auto it_document = it_word->second.find(document_id);
+        if (it_document == it_word->second.end()) {
+            continue;
+        }
+        for (uint32_t position : it_document->second.Decode()) {
+            positions.push_back({ position, i });
+        }
+    }
+    std::sort(positions.begin(), positions.end());
+    uint32_t min_distance = 0;
+    for (size_t i = 1; i < positions.size(); ++i) {
+        if (positions[i].second != positions[i - 1].second) {
+            const uint32_t distance = positions[i].first - positions[i - 1].first;
+            if (min_distance == 0 || distance < min_distance) {
+                min_distance = distance;
+            }
+        }
+    }
+    return min_distance == 0 ? 1.0 : 1.0 + 1.0 / min_distance;
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <algorithm>
 #include <numeric>
+#include <limits>
 #include <cmath>
 #include <map>
 #include <set>
@@ -9,36 +10,61 @@
 #include <utility>
 #include <vector>
 #include <execution>
+#include <iterator>
 #include "document.h"
 #include "string_processing.h"
 #include "concurrent_map.h"
+#include "position_list.h"
+#include "term_dictionary.h"
+#include "scoring_models.h"
 
 const int MAX_RESULT_DOCUMENT_COUNT = 5;
 const double DIVERGENCE_FOR_RELEVANCE = 1e-6;
+const int MAX_EXPANDED_TERMS = 64;
+
+// POSITIONAL          
+enum class IndexMode { BAG_OF_WORDS, POSITIONAL, };
+
+// PROXIMITY   ,      
+enum class RankingMode { DEFAULT, PROXIMITY, };
+
+// WILDCARD      '*'  '?'  ,  LITERAL   
+enum class PatternMode { LITERAL, WILDCARD, };
 
 class SearchServer {
 public:
 
     template <typename StringContainer>
-    explicit SearchServer(const StringContainer& stop_words);
-    explicit SearchServer(std::string_view stop_words_text);
-    explicit SearchServer(const std::string& stop_words_text);
+    explicit SearchServer(const StringContainer& stop_words, IndexMode index_mode = IndexMode::BAG_OF_WORDS);
+    explicit SearchServer(std::string_view stop_words_text, IndexMode index_mode = IndexMode::BAG_OF_WORDS);
+    explicit SearchServer(const std::string& stop_words_text, IndexMode index_mode = IndexMode::BAG_OF_WORDS);
+
+    void SetRankingMode(RankingMode ranking_mode);
+
+    void SetPatternMode(PatternMode pattern_mode);
 
     void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
 
-    template <typename ExecutionPolicy, typename DocumentPredicate>
+    //      : FindTopDocuments<Bm25Scoring>(...)
+    template <typename ScoringModel = TfIdfScoring, typename ExecutionPolicy, typename DocumentPredicate>
     std::vector<Document> FindTopDocuments(ExecutionPolicy policy, std::string_view raw_query, DocumentPredicate document_predicate) const;
-    template <typename DocumentPredicate>
+    template <typename ScoringModel = TfIdfScoring, typename DocumentPredicate>
     std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate) const;
-    template <typename ExecutionPolicy>
+    template <typename ScoringModel = TfIdfScoring, typename ExecutionPolicy>
     std::vector<Document> FindTopDocuments(ExecutionPolicy policy, std::string_view raw_query, DocumentStatus status) const;
-    template <typename ExecutionPolicy>
+    template <typename ScoringModel = TfIdfScoring, typename ExecutionPolicy>
     std::vector<Document> FindTopDocuments(ExecutionPolicy policy, std::string_view raw_query) const;
+    template <typename ScoringModel>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status) const;
+    template <typename ScoringModel>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
     std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status) const;
     std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
 
     int GetDocumentCount() const;
 
+    bool HasDocument(int document_id) const;
+
     using MatchDocument_Type = std::tuple<std::vector<std::string_view>, DocumentStatus>;
 
     MatchDocument_Type MatchDocument(std::string_view raw_query,
@@ -63,13 +89,20 @@ private:
         int rating;
         DocumentStatus status;
         std::string_view document;
+        int word_count;
     };
     const std::set<std::string, std::less<>> stop_words_;
+    const IndexMode index_mode_;
+    RankingMode ranking_mode_ = RankingMode::DEFAULT;
+    PatternMode pattern_mode_ = PatternMode::LITERAL;
     std::map<std::string, std::pair<std::string, std::string_view>> server_words_;
-    std::map<std::string_view, std::map<int, double>> word_to_document_freqs_;
+    std::map<std::string_view, std::map<int, int>> word_to_document_counts_;
     std::map<int, DocumentData> documents_;
     std::set<int> index_id_;
-    std::map<int, std::map<std::string_view, double>> id_words_freqs_;
+    std::map<int, std::map<std::string_view, int>> id_words_counts_;
+    int64_t total_word_count_ = 0;
+    std::map<std::string_view, std::map<int, PositionList>> word_to_document_positions_;
+    TermDictionary term_dictionary_;
 
     bool IsStopWord(std::string_view word) const;
 
@@ -87,24 +120,54 @@ private:
 
     QueryWord ParseQueryWord(std::string_view text) const;
 
+    // offset -        -
+    struct PhraseWord {
+        std::string_view data;
+        uint32_t offset;
+    };
+
+    using Phrase = std::vector<PhraseWord>;
+
     struct Query {
         std::vector<std::string_view> plus_words;
         std::vector<std::string_view> minus_words;
+        std::vector<Phrase> phrases;
+        // ,    ,    
+        std::vector<std::vector<std::string_view>> expanded_words;
     };
 
     Query ParseQuery(std::string_view text, bool skip_sort) const;
 
+    template <typename ScoringModel>
     double ComputeWordInverseDocumentFreq(std::string_view word) const;
 
-    template <typename ExecutionPolicy, typename DocumentPredicate>
+    double ComputeAverageDocumentLength() const;
+
+    std::vector<std::string_view> ExpandPattern(std::string_view pattern, size_t max_terms) const;
+
+    bool HasMinusWords(const Query& query, int document_id) const;
+
+    bool MatchesPhrase(const Phrase& phrase, int document_id) const;
+
+    bool MatchesPhrases(const Query& query, int document_id) const;
+
+    std::vector<int> FindPhraseCandidates(const Query& query) const;
+
+    double ComputeProximityBoost(const std::vector<std::string_view>& words, int document_id) const;
+
+    template <typename ScoringModel, typename ExecutionPolicy, typename DocumentPredicate>
     std::vector<Document> FindAllDocuments(ExecutionPolicy policy, const Query& query, DocumentPredicate document_predicate) const;
+
+    template <typename ScoringModel, typename ExecutionPolicy, typename DocumentPredicate>
+    std::vector<Document> FindPhraseDocuments(ExecutionPolicy policy, const Query& query, DocumentPredicate document_predicate) const;
 };
 
 //   --------------------------------------------------------------------------
 
 template <typename StringContainer>
-SearchServer::SearchServer(const StringContainer& stop_words)
+SearchServer::SearchServer(const StringContainer& stop_words, IndexMode index_mode)
     : stop_words_(MakeUniqueNonEmptyStrings(stop_words))
+    , index_mode_(index_mode)
 {
     for (const std::string& word : stop_words_)
         if (!IsValidWord(word))
@@ -113,10 +176,10 @@ SearchServer::SearchServer(const StringContainer& stop_words)
         }
 }
 
-template <typename ExecutionPolicy, typename DocumentPredicate>
+template <typename ScoringModel, typename ExecutionPolicy, typename DocumentPredicate>
 std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy policy, std::string_view raw_query, DocumentPredicate document_predicate) const {
     const Query query = ParseQuery(raw_query, false);
-    auto result = FindAllDocuments(policy, query, document_predicate);
+    auto result = FindAllDocuments<ScoringModel>(policy, query, document_predicate);
 
     std::sort(policy, result.begin(), result.end(),
         [](const Document& lhs, const Document& rhs) {
@@ -133,47 +196,88 @@ std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy policy, std
     return result;
 }
 
-template <typename DocumentPredicate>
+template <typename ScoringModel, typename DocumentPredicate>
 std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate) const {
-    return FindTopDocuments(std::execution::seq, raw_query, document_predicate);
+    return FindTopDocuments<ScoringModel>(std::execution::seq, raw_query, document_predicate);
 }
 
-template <typename ExecutionPolicy>
+template <typename ScoringModel, typename ExecutionPolicy>
 std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy policy, std::string_view raw_query, DocumentStatus status) const {
-    return FindTopDocuments(policy,
+    return FindTopDocuments<ScoringModel>(policy,
         raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
             return document_status == status;
         });
 }
 
-template <typename ExecutionPolicy>
+template <typename ScoringModel, typename ExecutionPolicy>
 std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy policy, std::string_view raw_query) const {
-    return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL);
+    return FindTopDocuments<ScoringModel>(policy, raw_query, DocumentStatus::ACTUAL);
 }
 
-template <typename ExecutionPolicy, typename DocumentPredicate>
+template <typename ScoringModel>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status) const {
+    return FindTopDocuments<ScoringModel>(std::execution::seq, raw_query, status);
+}
+
+template <typename ScoringModel>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query) const {
+    return FindTopDocuments<ScoringModel>(std::execution::seq, raw_query, DocumentStatus::ACTUAL);
+}
+
+template <typename ScoringModel>
+double SearchServer::ComputeWordInverseDocumentFreq(std::string_view word) const {
+    return ScoringModel::ComputeInverseDocumentFreq(GetDocumentCount(),
+        static_cast<int>(word_to_document_counts_.at(word).size()));
+}
+
+template <typename ScoringModel, typename ExecutionPolicy, typename DocumentPredicate>
 std::vector<Document> SearchServer::FindAllDocuments(ExecutionPolicy policy, const Query& query,
     DocumentPredicate document_predicate) const {
+    if (!query.phrases.empty()) {
+        return FindPhraseDocuments<ScoringModel>(policy, query, document_predicate);
+    }
+    const double average_length = ComputeAverageDocumentLength();
     ConcurrentMap<int, double> document_to_relevance(MAX_RESULT_DOCUMENT_COUNT);
     std::for_each(policy,
         query.plus_words.begin(), query.plus_words.end(),
         [&](std::string_view word) {
-            if (word_to_document_freqs_.count(word)) {
-                const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-                for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
+            if (word_to_document_counts_.count(word)) {
+                const double inverse_document_freq = ComputeWordInverseDocumentFreq<ScoringModel>(word);
+                for (const auto [document_id, term_count] : word_to_document_counts_.at(word)) {
                     const auto& document_data = documents_.at(document_id);
                     if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                        document_to_relevance[document_id].ref_to_value += term_freq * inverse_document_freq;
+                        document_to_relevance[document_id].ref_to_value += ScoringModel::ComputeScore(term_count,
+                            inverse_document_freq, ScoringModel::ComputeLengthNorm(document_data.word_count, average_length));
                     }
                 }
             }
         });
 
+    std::for_each(policy,
+        query.expanded_words.begin(), query.expanded_words.end(),
+        [&](const std::vector<std::string_view>& words) {
+            std::map<int, double> document_to_word_relevance;
+            for (std::string_view word : words) {
+                const double inverse_document_freq = ComputeWordInverseDocumentFreq<ScoringModel>(word);
+                for (const auto [document_id, term_count] : word_to_document_counts_.at(word)) {
+                    double& word_relevance = document_to_word_relevance[document_id];
+                    word_relevance = std::max(word_relevance, ScoringModel::ComputeScore(term_count, inverse_document_freq,
+                        ScoringModel::ComputeLengthNorm(documents_.at(document_id).word_count, average_length)));
+                }
+            }
+            for (const auto [document_id, word_relevance] : document_to_word_relevance) {
+                const auto& document_data = documents_.at(document_id);
+                if (document_predicate(document_id, document_data.status, document_data.rating)) {
+                    document_to_relevance[document_id].ref_to_value += word_relevance;
+                }
+            }
+        });
+
     std::for_each(policy,
         query.minus_words.begin(), query.minus_words.end(),
         [&](std::string_view word) {
-            if (word_to_document_freqs_.count(word)) {
-                for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
+            if (word_to_document_counts_.count(word)) {
+                for (const auto [document_id, _] : word_to_document_counts_.at(word)) {
                     document_to_relevance.Erase(document_id);
                 }
             }
@@ -185,6 +289,82 @@ std::vector<Document> SearchServer::FindAllDocuments(ExecutionPolicy policy, con
         matched_documents.push_back(
             { document_id, relevance, documents_.at(document_id).rating });
     }
+    if (ranking_mode_ == RankingMode::PROXIMITY) {
+        std::for_each(policy,
+            matched_documents.begin(), matched_documents.end(),
+            [&](Document& document) {
+                document.relevance *= ComputeProximityBoost(query.plus_words, document.id);
+            });
+    }
+    return matched_documents;
+}
+
+//     ,    ,    
+template <typename ScoringModel, typename ExecutionPolicy, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindPhraseDocuments(ExecutionPolicy policy, const Query& query,
+    DocumentPredicate document_predicate) const {
+    std::vector<int> candidates = FindPhraseCandidates(query);
+    auto it_candidates = std::remove_if(candidates.begin(), candidates.end(),
+        [&](int document_id) {
+            const auto& document_data = documents_.at(document_id);
+            return !document_predicate(document_id, document_data.status, document_data.rating)
+                || HasMinusWords(query, document_id);
+        });
+    candidates.erase(it_candidates, candidates.end());
+
+    std::vector<double> inverse_document_freqs(query.plus_words.size());
+    std::transform(query.plus_words.begin(), query.plus_words.end(), inverse_document_freqs.begin(),
+        [&](std::string_view word) {
+            return word_to_document_counts_.count(word) ? ComputeWordInverseDocumentFreq<ScoringModel>(word) : 0.0;
+        });
+    std::vector<std::vector<double>> expanded_inverse_document_freqs;
+    for (const auto& words : query.expanded_words) {
+        std::vector<double>& freqs = expanded_inverse_document_freqs.emplace_back(words.size());
+        std::transform(words.begin(), words.end(), freqs.begin(),
+            [&](std::string_view word) {
+                return ComputeWordInverseDocumentFreq<ScoringModel>(word);
+            });
+    }
+
+    const double average_length = ComputeAverageDocumentLength();
+    std::vector<Document> matched_documents(candidates.size());
+    std::transform(policy,
+        candidates.begin(), candidates.end(), matched_documents.begin(),
+        [&](int document_id) {
+            if (!MatchesPhrases(query, document_id)) {
+                return Document{ -1, 0.0, 0 };
+            }
+            const auto& word_counts = id_words_counts_.at(document_id);
+            const double length_norm = ScoringModel::ComputeLengthNorm(
+                documents_.at(document_id).word_count, average_length);
+            double relevance = 0.0;
+            for (size_t i = 0; i < query.plus_words.size(); ++i) {
+                const auto it = word_counts.find(query.plus_words[i]);
+                if (it != word_counts.end()) {
+                    relevance += ScoringModel::ComputeScore(it->second, inverse_document_freqs[i], length_norm);
+                }
+            }
+            for (size_t i = 0; i < query.expanded_words.size(); ++i) {
+                double word_relevance = 0.0;
+                for (size_t j = 0; j < query.expanded_words[i].size(); ++j) {
+                    const auto it = word_counts.find(query.expanded_words[i][j]);
+                    if (it != word_counts.end()) {
+                        word_relevance = std::max(word_relevance, ScoringModel::ComputeScore(
+                            it->second, expanded_inverse_document_freqs[i][j], length_norm));
+                    }
+                }
+                relevance += word_relevance;
+            }
+            if (ranking_mode_ == RankingMode::PROXIMITY) {
+                relevance *= ComputeProximityBoost(query.plus_words, document_id);
+            }
+            return Document{ document_id, relevance, documents_.at(document_id).rating };
+        });
+    auto it_matched = std::remove_if(matched_documents.begin(), matched_documents.end(),
+        [](const Document& document) {
+            return document.id < 0;
+        });
+    matched_documents.erase(it_matched, matched_documents.end());
     return matched_documents;
 }
 
@@ -0,0 +1,63 @@
+#include "term_dictionary.h"
+
+void TermDictionary::Insert(std::vector<std::string_view> terms) {
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    if (terms.empty()) {
+        return;
+    }
+
+    runs_.push_back(std::move(terms));
+    while (runs_.size() > 1 && runs_.back().size() * 2 >= runs_[runs_.size() - 2].size()) {
+        std::vector<std::string_view> last = std::move(runs_.back());
+        runs_.pop_back();
+        std::vector<std::string_view>& previous = runs_.back();
+        const auto previous_size = previous.size();
+        previous.insert(previous.end(), last.begin(), last.end());
+        std::inplace_merge(previous.begin(), previous.begin() + previous_size, previous.end());
+    }
+}
+
+size_t TermDictionary::Size() const {
+    size_t size = 0;
+    for (const auto& run : runs_) {
+        size += run.size();
+    }
+    return size;
+}
+
+bool TermDictionary::IsPattern(std::string_view word) {
+    return word.find_first_of("*?") != word.npos && word.find_first_not_of("*?") != word.npos;
+}
+
+std::string_view TermDictionary::GetLiteralPrefix(std::string_view pattern) {
+    return pattern.substr(0, pattern.find_first_of("*?"));
+}
+
+bool TermDictionary::MatchesPattern(std::string_view pattern, std::string_view term) {
+    size_t pattern_pos = 0;
+    size_t term_pos = 0;
+    size_t star_pos = pattern.npos;
+    size_t star_term_pos = 0;
+    while (term_pos < term.size()) {
+        if (pattern_pos < pattern.size() && (pattern[pattern_pos] == '?' || pattern[pattern_pos] == term[term_pos])) {
+            ++pattern_pos;
+            ++term_pos;
+        }
+        else if (pattern_pos < pattern.size() && pattern[pattern_pos] == '*') {
+            star_pos = pattern_pos++;
+            star_term_pos = term_pos;
+        }
+        else if (star_pos != pattern.npos) {
+            pattern_pos = star_pos + 1;
+            term_pos = ++star_term_pos;
+        }
+        else {
+            return false;
+        }
+    }
+    while (pattern_pos < pattern.size() && pattern[pattern_pos] == '*') {
+        ++pattern_pos;
+    }
+    return pattern_pos == pattern.size();
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+// Отсортированный словарь терминов для раскрытия шаблонов "cat*" и "c?t".
+// Хранится как набор неизменяемых отсортированных массивов, размеры которых убывают хотя бы вдвое:
+// новые термины образуют новый массив, а соседние массивы близкого размера сливаются,
+// так что каждый термин переписывается O(log n) раз. Строки терминов должны жить дольше словаря.
+class TermDictionary {
+public:
+    // terms не должны содержать уже добавленных в словарь терминов
+    void Insert(std::vector<std::string_view> terms);
+
+    // Возвращает не более max_terms подходящих под шаблон терминов в лексикографическом порядке
+    template <typename TermPredicate>
+    std::vector<std::string_view> Expand(std::string_view pattern, size_t max_terms, TermPredicate term_predicate) const;
+
+    size_t Size() const;
+
+    // Слово из одних '*' и '?' шаблоном не считается
+    static bool IsPattern(std::string_view word);
+
+private:
+    std::vector<std::vector<std::string_view>> runs_;
+
+    static std::string_view GetLiteralPrefix(std::string_view pattern);
+
+    static bool MatchesPattern(std::string_view pattern, std::string_view term);
+};
+
+template <typename TermPredicate>
+std::vector<std::string_view> TermDictionary::Expand(std::string_view pattern, size_t max_terms,
+    TermPredicate term_predicate) const {
+    const std::string_view prefix = GetLiteralPrefix(pattern);
+    std::vector<std::string_view> result;
+    for (const auto& run : runs_) {
+        const auto run_begin = result.size();
+        size_t found = 0;
+        for (auto it = std::lower_bound(run.begin(), run.end(), prefix);
+            it != run.end() && it->substr(0, prefix.size()) == prefix && found < max_terms; ++it) {
+            if (MatchesPattern(pattern, *it) && term_predicate(*it)) {
+                result.push_back(*it);
+                ++found;
+            }
+        }
+        std::inplace_merge(result.begin(), result.begin() + run_begin, result.end());
+    }
+    if (result.size() > max_terms) {
+        result.resize(max_terms);
+    }
+    return result;
+}
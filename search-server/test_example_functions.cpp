@@ -0,0 +1,453 @@
+#include "test_example_functions.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "corpus_loader.h"
+#include "search_server.h"
+#include "daemon/request_handler.h"
+
+namespace {
+
+void AssertImpl(bool value, const std::string& expr_str, const std::string& file,
+    const std::string& func, unsigned line) {
+    if (!value) {
+        std::cerr << file << "(" << line << "): " << func << ": ASSERT(" << expr_str << ") failed." << std::endl;
+        std::abort();
+    }
+}
+
+#define ASSERT(expr) AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__)
+
+template <typename Function>
+bool ThrowsInvalidArgument(Function function) {
+    try {
+        function();
+    }
+    catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+std::vector<int> GetIds(const std::vector<Document>& documents) {
+    std::vector<int> ids;
+    for (const Document& document : documents) {
+        ids.push_back(document.id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+std::string WriteTempFile(const std::string& name, const std::string& content) {
+    const std::string path = (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream(path, std::ios::binary) << content;
+    return path;
+}
+
+// Возвращает текст ошибки загрузки или пустую строку, если загрузка прошла успешно
+std::string GetLoadError(const std::string& content, CorpusFormat format, SearchServer& server) {
+    const std::string path = WriteTempFile("search_server_test_corpus", content);
+    Corpus corpus(path, format);
+    std::filesystem::remove(path);
+    try {
+        corpus.LoadInto(server);
+    }
+    catch (const std::invalid_argument& e) {
+        return e.what();
+    }
+    return {};
+}
+
+} // namespace
+
+void TestPhraseQueries() {
+    SearchServer server(std::string{ "and with" }, IndexMode::POSITIONAL);
+    server.AddDocument(1, "white cat and yellow hat", DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, "yellow hat white cat", DocumentStatus::ACTUAL, { 2 });
+    server.AddDocument(3, "cat with yellow collar", DocumentStatus::ACTUAL, { 3 });
+    server.AddDocument(4, "white dog and white cat", DocumentStatus::ACTUAL, { 4 });
+
+    ASSERT((GetIds(server.FindTopDocuments("\"white cat\"")) == std::vector<int>{ 1, 2, 4 }));
+    ASSERT((GetIds(server.FindTopDocuments("\"cat yellow\"")) == std::vector<int>{}));
+    // стоп-слово внутри фразы занимает позицию, но совпадает с любым словом
+    ASSERT((GetIds(server.FindTopDocuments("\"cat and yellow\"")) == std::vector<int>{ 1, 3 }));
+    ASSERT((GetIds(server.FindTopDocuments("\"cat and yellow\" -collar")) == std::vector<int>{ 1 }));
+    ASSERT((GetIds(server.FindTopDocuments(std::execution::par, "\"hat white cat\"")) == std::vector<int>{ 2 }));
+    // фраза только из стоп-слов не ограничивает поиск
+    ASSERT((GetIds(server.FindTopDocuments("\"and with\" collar")) == std::vector<int>{ 3 }));
+    ASSERT((GetIds(server.FindTopDocuments("\"\" collar")) == std::vector<int>{ 3 }));
+
+    ASSERT(ThrowsInvalidArgument([&] { server.FindTopDocuments("\"white cat"); }));
+    ASSERT(ThrowsInvalidArgument([&] { server.FindTopDocuments("\""); }));
+    ASSERT(ThrowsInvalidArgument([&] { server.FindTopDocuments("cat \" hat"); }));
+    ASSERT(ThrowsInvalidArgument([&] { server.FindTopDocuments("-\"white cat\""); }));
+    ASSERT(ThrowsInvalidArgument([&] { server.FindTopDocuments("\"cat \"sat\""); }));
+
+    {
+        const auto [words, status] = server.MatchDocument("\"white cat\" hat", 2);
+        ASSERT((words == std::vector<std::string_view>{ "cat", "hat", "white" }));
+        ASSERT(status == DocumentStatus::ACTUAL);
+    }
+    {
+        const auto [words, status] = server.MatchDocument(std::execution::par, "\"white cat\" hat", 2);
+        ASSERT((words == std::vector<std::string_view>{ "cat", "hat", "white" }));
+    }
+    {
+        const auto [words, status] = server.MatchDocument(std::execution::par, "\"hat white\" dog", 4);
+        ASSERT(words.empty());
+    }
+    {
+        const auto [words, status] = server.MatchDocument(std::execution::par, "\"hat white\" dog", 2);
+        ASSERT((words == std::vector<std::string_view>{ "hat", "white" }));
+    }
+    // документ только из стоп-слов
+    server.AddDocument(5, "and with", DocumentStatus::BANNED, { 5 });
+    for (std::string_view query : { "", "and", "cat -dog", "\"white cat\"" }) {
+        const auto [words, status] = server.MatchDocument(query, 5);
+        ASSERT(words.empty() && status == DocumentStatus::BANNED);
+        const auto [par_words, par_status] = server.MatchDocument(std::execution::par, query, 5);
+        ASSERT(par_words.empty() && par_status == DocumentStatus::BANNED);
+    }
+
+    server.RemoveDocument(2);
+    ASSERT((GetIds(server.FindTopDocuments("\"white cat\"")) == std::vector<int>{ 1, 4 }));
+    server.RemoveDocument(std::execution::par, 4);
+    ASSERT((GetIds(server.FindTopDocuments("\"white cat\"")) == std::vector<int>{ 1 }));
+    ASSERT((GetIds(server.FindTopDocuments("\"white dog\"")) == std::vector<int>{}));
+
+    // без позиционного индекса кавычки остаются частью слова
+    SearchServer plain_server(std::string{ "and with" });
+    plain_server.AddDocument(1, "\"white cat\"", DocumentStatus::ACTUAL, { 1 });
+    ASSERT((GetIds(plain_server.FindTopDocuments("\"white")) == std::vector<int>{ 1 }));
+}
+
+void TestTermDictionary() {
+    const auto any_term = [](std::string_view) { return true; };
+    TermDictionary dictionary;
+    dictionary.Insert({ "abd", "b", "ab" });
+    dictionary.Insert({ "a" });
+    dictionary.Insert({ "ba", "acb", "abc" });
+    ASSERT(dictionary.Size() == 7);
+
+    using Terms = std::vector<std::string_view>;
+    ASSERT((dictionary.Expand("a*", 10, any_term) == Terms{ "a", "ab", "abc", "abd", "acb" }));
+    ASSERT((dictionary.Expand("a**", 10, any_term) == Terms{ "a", "ab", "abc", "abd", "acb" }));
+    ASSERT((dictionary.Expand("a?", 10, any_term) == Terms{ "ab" }));
+    ASSERT((dictionary.Expand("ab?", 10, any_term) == Terms{ "abc", "abd" }));
+    ASSERT((dictionary.Expand("a*b", 10, any_term) == Terms{ "ab", "acb" }));
+    ASSERT((dictionary.Expand("a*c*", 10, any_term) == Terms{ "abc", "acb" }));
+    ASSERT((dictionary.Expand("a?*", 10, any_term) == Terms{ "ab", "abc", "abd", "acb" }));
+    ASSERT((dictionary.Expand("ab*d", 10, any_term) == Terms{ "abd" }));
+    ASSERT((dictionary.Expand("c*", 10, any_term) == Terms{}));
+    ASSERT((dictionary.Expand("a*", 2, any_term) == Terms{ "a", "ab" }));
+    ASSERT((dictionary.Expand("a*", 10, [](std::string_view term) { return term.size() == 3; })
+        == Terms{ "abc", "abd", "acb" }));
+
+    ASSERT(TermDictionary::IsPattern("ca*"));
+    ASSERT(TermDictionary::IsPattern("c?t"));
+    ASSERT(!TermDictionary::IsPattern("cat"));
+    ASSERT(!TermDictionary::IsPattern("?"));
+    ASSERT(!TermDictionary::IsPattern("**"));
+}
+
+void TestPatternQueries() {
+    SearchServer server(std::string{ "and with" });
+    server.AddDocument(1, "white cat and yellow hat", DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, "curly cats it?", DocumentStatus::ACTUAL, { 2 });
+    server.AddDocument(3, "catalog with yellow", DocumentStatus::ACTUAL, { 3 });
+    server.AddDocument(4, "what ? cut", DocumentStatus::ACTUAL, { 4 });
+
+    // по умолчанию '*' и '?' - обычные символы
+    ASSERT((GetIds(server.FindTopDocuments("cat*")) == std::vector<int>{}));
+    ASSERT((GetIds(server.FindTopDocuments("it?")) == std::vector<int>{ 2 }));
+    ASSERT((GetIds(server.FindTopDocuments("what ?")) == std::vector<int>{ 4 }));
+
+    server.SetPatternMode(PatternMode::WILDCARD);
+    ASSERT((GetIds(server.FindTopDocuments("cat*")) == std::vector<int>{ 1, 2, 3 }));
+    ASSERT((GetIds(server.FindTopDocuments(std::execution::par, "cat* -catalog")) == std::vector<int>{ 1, 2 }));
+    ASSERT((GetIds(server.FindTopDocuments("c?t")) == std::vector<int>{ 1, 4 }));
+    ASSERT((GetIds(server.FindTopDocuments("hat -ca*")) == std::vector<int>{}));
+    ASSERT((GetIds(server.FindTopDocuments("what ?")) == std::vector<int>{ 4 }));
+    ASSERT(ThrowsInvalidArgument([&] { server.FindTopDocuments("*at"); }));
+
+    // повторённый шаблон ранжируется как одно слово
+    const auto single = server.FindTopDocuments("ca*");
+    const auto repeated = server.FindTopDocuments("ca* ca*");
+    ASSERT(single.size() == repeated.size());
+    for (size_t i = 0; i < single.size(); ++i) {
+        ASSERT(single[i].id == repeated[i].id);
+        ASSERT(std::abs(single[i].relevance - repeated[i].relevance) < DIVERGENCE_FOR_RELEVANCE);
+    }
+
+    {
+        const auto [words, status] = server.MatchDocument("ca* hat", 1);
+        ASSERT((words == std::vector<std::string_view>{ "cat", "hat" }));
+    }
+    {
+        const auto [words, status] = server.MatchDocument(std::execution::par, "ca* hat", 2);
+        ASSERT((words == std::vector<std::string_view>{ "cats" }));
+    }
+
+    // раскрытие ограничено MAX_EXPANDED_TERMS словами
+    std::string text;
+    for (int i = 0; i < MAX_EXPANDED_TERMS * 2; ++i) {
+        text += "w" + std::to_string(1000 + i) + " ";
+    }
+    server.AddDocument(5, text, DocumentStatus::ACTUAL, { 5 });
+    const auto [words, status] = server.MatchDocument("w*", 5);
+    ASSERT(words.size() == MAX_EXPANDED_TERMS);
+    ASSERT(words.front() == "w1000");
+
+    // минус-шаблон исключает документы и со словами за пределом MAX_EXPANDED_TERMS
+    const std::string last_word = "w" + std::to_string(1000 + MAX_EXPANDED_TERMS * 2 - 1);
+    server.AddDocument(6, "apple " + last_word, DocumentStatus::ACTUAL, { 6 });
+    server.AddDocument(7, "apple", DocumentStatus::ACTUAL, { 7 });
+    ASSERT((GetIds(server.FindTopDocuments("apple -w*")) == std::vector<int>{ 7 }));
+    ASSERT((GetIds(server.FindTopDocuments(std::execution::par, "apple -w*")) == std::vector<int>{ 7 }));
+    ASSERT(std::get<0>(server.MatchDocument("apple -w*", 6)).empty());
+    ASSERT(std::get<0>(server.MatchDocument(std::execution::par, "apple -w*", 6)).empty());
+}
+
+void TestScoringModels() {
+    const auto is_near = [](double lhs, double rhs) {
+        return std::abs(lhs - rhs) < DIVERGENCE_FOR_RELEVANCE;
+    };
+    SearchServer server(std::string{ "and" });
+    server.AddDocument(1, "cat dog", DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, "cat and cat bird mouse", DocumentStatus::ACTUAL, { 2 });
+    server.AddDocument(3, "bird", DocumentStatus::BANNED, { 3 });
+
+    {
+        const auto documents = server.FindTopDocuments("cat");
+        ASSERT(documents.size() == 2 && documents[0].id == 2 && documents[1].id == 1);
+        ASSERT(is_near(documents[0].relevance, 2.0 / 4.0 * std::log(3.0 / 2.0)));
+        ASSERT(is_near(documents[1].relevance, 1.0 / 2.0 * std::log(3.0 / 2.0)));
+    }
+
+    // k1 = 1.2, b = 0.75, средняя длина документа 7 / 3
+    const auto bm25 = [](int term_count, int document_length, int document_count, int document_freq, double average_length) {
+        const double idf = std::log(1.0 + (document_count - document_freq + 0.5) / (document_freq + 0.5));
+        const double norm = 1.2 * (1.0 - 0.75 + 0.75 * document_length / average_length);
+        return idf * term_count * 2.2 / (term_count + norm);
+    };
+    {
+        const auto documents = server.FindTopDocuments<Bm25Scoring>("cat");
+        ASSERT(documents.size() == 2 && documents[0].id == 2 && documents[1].id == 1);
+        ASSERT(is_near(documents[0].relevance, bm25(2, 4, 3, 2, 7.0 / 3.0)));
+        ASSERT(is_near(documents[1].relevance, bm25(1, 2, 3, 2, 7.0 / 3.0)));
+    }
+    {
+        const auto documents = server.FindTopDocuments<Bm25Scoring>(std::execution::par, "bird dog", DocumentStatus::BANNED);
+        ASSERT(documents.size() == 1 && documents[0].id == 3);
+        ASSERT(is_near(documents[0].relevance, bm25(1, 1, 3, 2, 7.0 / 3.0)));
+    }
+
+    // после изменения индекса IDF и средняя длина пересчитываются
+    server.RemoveDocument(3);
+    {
+        const auto documents = server.FindTopDocuments<Bm25Scoring>(std::execution::par, "cat");
+        ASSERT(documents.size() == 2);
+        ASSERT(is_near(documents[0].relevance, bm25(2, 4, 2, 2, 3.0)));
+        ASSERT(is_near(documents[1].relevance, bm25(1, 2, 2, 2, 3.0)));
+    }
+    server.AddDocument(4, "mouse", DocumentStatus::ACTUAL, { 4 });
+    {
+        const auto documents = server.FindTopDocuments<Bm25Scoring>("mouse", [](int document_id, DocumentStatus, int) {
+            return document_id == 4;
+        });
+        ASSERT(documents.size() == 1);
+        ASSERT(is_near(documents[0].relevance, bm25(1, 1, 3, 2, 7.0 / 3.0)));
+    }
+
+    {
+        const auto frequencies = server.GetWordFrequencies(2);
+        ASSERT(frequencies.size() == 3);
+        ASSERT(is_near(frequencies.at("cat"), 0.5));
+        ASSERT(is_near(frequencies.at("mouse"), 0.25));
+    }
+}
+
+void TestCorpus() {
+    {
+        // CRLF, пустая строка и последняя строка без перевода строки
+        const std::string path = WriteTempFile("search_server_test_corpus.tsv",
+            "1\tACTUAL\t1 2 3\twhite cat\r\n"
+            "2\tBANNED\t\tcurly dog\n"
+            "\n"
+            "3\tIRRELEVANT\t-4\tfluffy cat");
+        Corpus corpus(path, CorpusFormat::TSV);
+        std::filesystem::remove(path);
+        SearchServer server(std::string{ "and" });
+        ASSERT(corpus.LoadInto(server) == 3);
+        const auto documents = server.FindTopDocuments("cat");
+        ASSERT(documents.size() == 1 && documents[0].id == 1 && documents[0].rating == 2);
+        ASSERT((GetIds(server.FindTopDocuments("dog", DocumentStatus::BANNED)) == std::vector<int>{ 2 }));
+        ASSERT((GetIds(server.FindTopDocuments("cat", DocumentStatus::IRRELEVANT)) == std::vector<int>{ 3 }));
+    }
+    {
+        const std::string path = WriteTempFile("search_server_test_corpus.jsonl",
+            "{\"id\": 10, \"status\": \"BANNED\", \"ratings\": [4, 6], \"text\": \"say \\\"cat\\\" caf\\u00e9\"}\n"
+            "{ \"text\": \"smile \\ud83d\\ude00 and\\/or cat\", \"extra\": {\"a\": [1, \"}\"]}, \"id\": 11 }\r\n"
+            "{\"id\": 12, \"ratings\": [], \"text\": \"plain cat\"}\n");
+        Corpus corpus(path, CorpusFormat::JSONL);
+        std::filesystem::remove(path);
+        SearchServer server(std::string{});
+        ASSERT(corpus.LoadInto(server) == 3);
+        // раскодированные тексты хранит Corpus, сервер ссылается на них
+        const auto documents = server.FindTopDocuments("caf\u00e9", DocumentStatus::BANNED);
+        ASSERT(documents.size() == 1 && documents[0].id == 10 && documents[0].rating == 5);
+        ASSERT((GetIds(server.FindTopDocuments("\"cat\"", DocumentStatus::BANNED)) == std::vector<int>{ 10 }));
+        ASSERT((GetIds(server.FindTopDocuments("\U0001F600 and/or")) == std::vector<int>{ 11 }));
+        ASSERT((GetIds(server.FindTopDocuments("cat")) == std::vector<int>{ 11, 12 }));
+    }
+    {
+        // на многоядерной машине файл делится на несколько кусков: документы на границах не теряются
+        const int document_count = 40'000;
+        std::string content;
+        for (int id = 0; id < document_count; ++id) {
+            content += std::to_string(id) + "\tACTUAL\t1\tword" + std::to_string(id) + std::string(50, ' ') + "common\n";
+        }
+        const std::string path = WriteTempFile("search_server_test_corpus.tsv", content);
+        SearchServer server(std::string{});
+        {
+            Corpus corpus(path, CorpusFormat::TSV);
+            ASSERT(corpus.LoadInto(server) == document_count);
+            ASSERT(server.GetDocumentCount() == document_count);
+            ASSERT(server.HasDocument(0) && server.HasDocument(document_count - 1));
+            ASSERT((GetIds(server.FindTopDocuments("word12345")) == std::vector<int>{ 12345 }));
+        }
+        SearchServer other_server(std::string{});
+        ASSERT(GetLoadError(content + "oops\n", CorpusFormat::TSV, other_server).find(
+            "line " + std::to_string(document_count + 1) + ": expected 4 tab-separated fields") != std::string::npos);
+        ASSERT(other_server.GetDocumentCount() == 0);
+        std::filesystem::remove(path);
+    }
+
+    // любая ошибка обнаруживается до добавления первого документа
+    const std::vector<std::tuple<CorpusFormat, std::string, std::string>> broken_corpora = {
+        { CorpusFormat::TSV, "1\tACTUAL\t\tcat\n2\tACTUAL\t\tdog\n1\tACTUAL\t\tbird\n", "line 3: duplicate id 1" },
+        { CorpusFormat::TSV, "1\tACTUAL\t\tcat\n100\tACTUAL\t\tdog\n", "line 2: id 100 is already in the server" },
+        { CorpusFormat::TSV, "1\tACTUAL\t\tcat\n-5\tACTUAL\t\tdog\n", "line 2: negative id" },
+        { CorpusFormat::TSV, "1\tACTUAL\t\tcat\n2\tWRONG\t\tdog\n", "line 2: unknown status \"WRONG\"" },
+        { CorpusFormat::TSV, "1\tACTUAL\t\tcat\n2\tACTUAL\t\tdo\x01g\n", "line 2: control characters in text" },
+        { CorpusFormat::JSONL, "{\"id\": 1, \"text\": \"cat\"}\n{\"id\": 2, \"text\": \"a\\u0001b\"}\n",
+            "line 2: control characters in text" },
+        { CorpusFormat::JSONL, "{\"id\": 1, \"text\": \"cat\"} garbage\n", "line 1: unexpected characters after object" },
+        { CorpusFormat::JSONL, "{\"id\": 1 \"text\": \"cat\"}\n", "line 1: expected '}'" },
+        { CorpusFormat::JSONL, "{\"id\": 1, \"ratings\": [1 2], \"text\": \"cat\"}\n", "line 1: expected ']'" },
+        { CorpusFormat::JSONL, "{\"id\": 1, \"text\": \"cat\",}\n", "line 1: expected '\"'" },
+        { CorpusFormat::JSONL, "{\"id\": 1, \"text\": \"\\ud800\\u0041\"}\n", "line 1: unpaired surrogate" },
+        { CorpusFormat::JSONL, "{\"id\": 1, \"text\": \"\\ud800 cat\"}\n", "line 1: unpaired surrogate" },
+        { CorpusFormat::JSONL, "{\"id\": 1, \"text\": \"\\udc00\"}\n", "line 1: unpaired surrogate" },
+    };
+    for (const auto& [format, content, expected_error] : broken_corpora) {
+        SearchServer server(std::string{});
+        server.AddDocument(100, "old document", DocumentStatus::ACTUAL, { 1 });
+        const std::string error = GetLoadError(content, format, server);
+        ASSERT(error.find(expected_error) != std::string::npos);
+        ASSERT(server.GetDocumentCount() == 1 && server.HasDocument(100));
+    }
+
+    SearchServer server(std::string{});
+    ASSERT(GetLoadError("", CorpusFormat::TSV, server).empty());
+    ASSERT(GetLoadError("", CorpusFormat::JSONL, server).empty());
+    ASSERT(server.GetDocumentCount() == 0);
+}
+
+void TestRequestHandler() {
+    SearchServer server(std::string{ "and" });
+    server.AddDocument(1, "white cat", DocumentStatus::ACTUAL, { 2 });
+    server.AddDocument(2, "black dog", DocumentStatus::BANNED, { 3 });
+    ASSERT(server.HasDocument(2));
+    ASSERT(!server.HasDocument(99));
+
+    ASSERT(HandleRequest(server, "FIND cat") == "OK 1:0.346574:2");
+    ASSERT(HandleRequest(server, "FIND bird") == "OK");
+    ASSERT(HandleRequest(server, "MATCH 1 white cat -dog") == "OK ACTUAL cat white");
+    ASSERT(HandleRequest(server, "MATCH 2 cat") == "OK BANNED");
+    ASSERT(HandleRequest(server, "MATCH 99 cat") == "ERROR unknown document");
+
+    for (std::string_view request : { "MATCH x cat", "MATCH 1", "MATCH 1cat", "MATCH -" }) {
+        ASSERT(HandleRequest(server, request) == "ERROR expected MATCH <document_id> <query>");
+    }
+    for (std::string_view request : { "", "find cat", "FIND", "MATCH", "DELETE 1" }) {
+        ASSERT(HandleRequest(server, request) == "ERROR unknown command");
+    }
+    // ошибки разбора запроса возвращаются как ERROR с текстом исключения
+    for (std::string_view request : { "FIND cat --dog", "FIND cat -", "MATCH 1 cat --dog" }) {
+        const std::string response = HandleRequest(server, request);
+        ASSERT(response.substr(0, 6) == "ERROR " && response.size() > 6);
+    }
+
+    const std::vector<std::string> requests = { "FIND cat", "MATCH 99 cat", "FIND dog" };
+    ASSERT((HandleRequests(server, requests)
+        == std::vector<std::string>{ "OK 1:0.346574:2", "ERROR unknown document", "OK" }));
+}
+
+void TestSearchServer() {
+    TestPhraseQueries();
+    TestTermDictionary();
+    TestPatternQueries();
+    TestScoringModels();
+    TestCorpus();
+    TestRequestHandler();
+}
+
+void BenchmarkPatternExpansion(int term_count) {
+    using Clock = std::chrono::steady_clock;
+    std::mt19937 generator(1);
+    std::vector<std::string> words;
+    for (int i = 0; i < term_count; ++i) {
+        std::string word(4 + generator() % 8, ' ');
+        for (char& c : word) {
+            c = static_cast<char>('a' + generator() % 26);
+        }
+        words.push_back(std::move(word));
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    std::shuffle(words.begin(), words.end(), generator);
+
+    // слова добавляются порциями, как новые слова документов в AddDocument
+    const size_t batch_size = 20;
+    TermDictionary dictionary;
+    const auto build_start = Clock::now();
+    for (size_t i = 0; i < words.size(); i += batch_size) {
+        dictionary.Insert(std::vector<std::string_view>(words.begin() + i,
+            words.begin() + std::min(words.size(), i + batch_size)));
+    }
+    const auto build_end = Clock::now();
+
+    const auto any_term = [](std::string_view) { return true; };
+    const int query_count = 100000;
+    size_t expanded_count = 0;
+    for (int i = 0; i < query_count; ++i) {
+        const std::string pattern = words[generator() % words.size()].substr(0, 3) + "*";
+        expanded_count += dictionary.Expand(pattern, MAX_EXPANDED_TERMS, any_term).size();
+    }
+    const auto prefix_end = Clock::now();
+    for (int i = 0; i < query_count; ++i) {
+        const std::string pattern = words[generator() % words.size()].substr(0, 2) + "?*e";
+        expanded_count += dictionary.Expand(pattern, MAX_EXPANDED_TERMS, any_term).size();
+    }
+    const auto wildcard_end = Clock::now();
+
+    const auto per_query_us = [query_count](Clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count() / query_count;
+    };
+    std::cout << "Terms: " << dictionary.Size()
+        << ", build: " << std::chrono::duration_cast<std::chrono::milliseconds>(build_end - build_start).count() << " ms"
+        << ", prefix \"abc*\": " << per_query_us(prefix_end - build_end) << " us"
+        << ", wildcard \"ab?*e\": " << per_query_us(wildcard_end - prefix_end) << " us"
+        << ", expanded terms: " << expanded_count << std::endl;
+}
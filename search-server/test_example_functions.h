@@ -0,0 +1,21 @@
+#pragma once
+
+void TestPhraseQueries();
+
+void TestTermDictionary();
+
+void TestPatternQueries();
+
+void TestScoringModels();
+
+// Пишет временные файлы корпуса и проверяет загрузку и ошибки разбора
+void TestCorpus();
+
+// Проверяет протокол демона: формат ответов и сообщения об ошибках
+void TestRequestHandler();
+
+// Запускает все тесты; при ошибке печатает проверку и завершает программу
+void TestSearchServer();
+
+// Замеряет построение словаря из term_count случайных слов и раскрытие по нему префиксов и шаблонов
+void BenchmarkPatternExpansion(int term_count);